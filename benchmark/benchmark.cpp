@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSettings>
+#include <QTextStream>
+#include "benchmark.h"
+
+Benchmark::Benchmark(const Options &options, QObject *parent) : QObject(parent), m_options(options), m_broker(new Broker(this)), m_process(new QProcess(this)), m_timer(new QTimer(this)), m_stage(Stage::startup), m_round(0), m_sent(0), m_lost(0), m_duration(0)
+{
+    connect(m_broker, &Broker::messageReceived, this, &Benchmark::messageReceived);
+    connect(m_timer, &QTimer::timeout, this, &Benchmark::timeout);
+
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    m_process->setStandardOutputFile(QProcess::nullDevice());
+    m_timer->setSingleShot(true);
+}
+
+Benchmark::~Benchmark(void)
+{
+    if (m_process->state() == QProcess::NotRunning)
+        return;
+
+    m_process->terminate();
+
+    if (!m_process->waitForFinished(5000))
+        m_process->kill();
+}
+
+bool Benchmark::start(void)
+{
+    QString configFile = m_directory.filePath("homed-modbus.conf");
+
+    if (!m_directory.isValid() || !writeConfig(configFile))
+    {
+        QTextStream(stderr) << "Benchmark configuration write failed\n";
+        return false;
+    }
+
+    if (!m_broker->listen(m_options.port))
+    {
+        QTextStream(stderr) << "Broker stand-in listen on port " << m_options.port << " failed\n";
+        return false;
+    }
+
+    m_process->start(m_options.service, {"-c", configFile});
+
+    if (!m_process->waitForStarted())
+    {
+        QTextStream(stderr) << "Service " << m_options.service << " start failed\n";
+        return false;
+    }
+
+    m_timer->start(BENCHMARK_STARTUP_TIMEOUT);
+    return true;
+}
+
+bool Benchmark::writeConfig(const QString &configFile)
+{
+    QSettings config(configFile, QSettings::IniFormat);
+    QString link = m_directory.filePath("ttySIM");
+    QJsonArray devices;
+    QFile file(m_directory.filePath("database.json"));
+
+    config.setValue("log/enabled", false);
+
+    config.setValue("mqtt/host", "127.0.0.1");
+    config.setValue("mqtt/port", m_options.port);
+    config.setValue("mqtt/prefix", "homed");
+    config.setValue("mqtt/names", true);
+
+    config.setValue("device/database", file.fileName());
+
+    if (!m_options.expose.isEmpty())
+        config.setValue("device/expose", m_options.expose);
+
+    config.setValue("simulator/enabled", true);
+    config.setValue("simulator/link", link);
+    config.setValue("simulator/latency", m_options.latency);
+
+    config.setValue("port-1/port", link);
+    config.setValue("port-1/statisticsInterval", 1000);
+
+    config.sync();
+
+    for (int i = 0; i < m_options.devices; i++)
+        devices.append(QJsonObject {{"name", QString("benchmark_%1").arg(i + 1)}, {"type", m_options.type}, {"portId", 1}, {"slaveId", i + 1}, {"baudRate", 9600}, {"pollInterval", m_options.pollInterval}, {"active", true}});
+
+    if (config.status() != QSettings::NoError || !file.open(QFile::WriteOnly))
+        return false;
+
+    file.write(QJsonDocument(QJsonObject {{"devices", devices}, {"names", true}}).toJson(QJsonDocument::Compact));
+    file.close();
+
+    return true;
+}
+
+void Benchmark::startRound(void)
+{
+    if (m_round >= m_options.commands)
+    {
+        m_duration = m_elapsed.elapsed();
+        m_stage = Stage::results;
+        m_broker->publish("homed/command/modbus", QJsonDocument(QJsonObject {{"action", "getBenchmark"}}).toJson(QJsonDocument::Compact));
+        m_timer->start(BENCHMARK_RESULT_TIMEOUT);
+        return;
+    }
+
+    for (auto it = m_status.begin(); it != m_status.end(); it++)
+    {
+        m_pending.insert(it.key(), m_elapsed.elapsed());
+        m_broker->publish(QString("homed/td/modbus/%1/1").arg(it.key()), QJsonDocument(QJsonObject {{"status", "toggle"}}).toJson(QJsonDocument::Compact));
+        m_sent++;
+    }
+
+    m_timer->start(m_options.timeout);
+}
+
+void Benchmark::finish(bool success)
+{
+    QJsonObject json, latency;
+
+    m_timer->stop();
+    std::sort(m_samples.begin(), m_samples.end());
+
+    json.insert("devices", m_options.devices);
+    json.insert("online", m_status.count());
+    json.insert("sent", m_sent);
+    json.insert("completed", m_samples.count());
+    json.insert("lost", m_lost);
+    json.insert("duration", m_duration);
+
+    if (m_duration)
+        json.insert("throughput", m_samples.count() * 1000.0 / m_duration);
+
+    if (!m_samples.isEmpty())
+    {
+        qint64 total = 0;
+
+        for (int i = 0; i < m_samples.count(); i++)
+            total += m_samples.at(i);
+
+        latency.insert("min", m_samples.first());
+        latency.insert("avg", static_cast <double> (total) / m_samples.count());
+        latency.insert("p50", m_samples.at(m_samples.count() * 50 / 100));
+        latency.insert("p90", m_samples.at(m_samples.count() * 90 / 100));
+        latency.insert("p99", m_samples.at(m_samples.count() * 99 / 100));
+        latency.insert("max", m_samples.last());
+        json.insert("latency", latency);
+    }
+
+    if (!m_service.isEmpty())
+        json.insert("service", m_service);
+
+    if (!m_statistics.isEmpty())
+        json.insert("statistics", m_statistics);
+
+    QTextStream(stdout) << QJsonDocument(json).toJson();
+    QCoreApplication::exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+void Benchmark::messageReceived(const QString &topic, const QByteArray &message)
+{
+    QList <QString> list = topic.split('/');
+    QJsonObject json = QJsonDocument::fromJson(message).object();
+
+    if (list.value(1) == "fd" && list.value(4) == "1" && json.contains("status"))
+    {
+        QString name = list.value(3), status = json.value("status").toString();
+
+        if (m_stage == Stage::commands && m_pending.contains(name) && m_status.value(name) != status)
+        {
+            m_samples.append(m_elapsed.elapsed() - m_pending.take(name));
+
+            if (m_pending.isEmpty())
+            {
+                m_timer->stop();
+                m_round++;
+                startRound();
+            }
+        }
+
+        m_status.insert(name, status);
+
+        if (m_stage == Stage::startup && m_status.count() == m_options.devices)
+        {
+            m_stage = Stage::commands;
+            m_elapsed.start();
+            startRound();
+        }
+
+        return;
+    }
+
+    if (list.value(1) == "statistics")
+    {
+        m_statistics = json;
+        return;
+    }
+
+    if (list.value(1) == "benchmark" && m_stage == Stage::results)
+    {
+        m_service = json;
+        finish(true);
+    }
+}
+
+void Benchmark::timeout(void)
+{
+    switch (m_stage)
+    {
+        case Stage::startup:
+            QTextStream(stderr) << "Only " << m_status.count() << " of " << m_options.devices << " devices reported status\n";
+            finish(false);
+            break;
+
+        case Stage::commands:
+            m_lost += m_pending.count();
+            m_pending.clear();
+            m_round++;
+            startRound();
+            break;
+
+        case Stage::results:
+            finish(false);
+            break;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#define BENCHMARK_STARTUP_TIMEOUT   30000
+#define BENCHMARK_RESULT_TIMEOUT    5000
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTimer>
+#include "broker.h"
+
+class Benchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct Options
+    {
+        QString service, type, expose;
+        quint16 port;
+        int devices, commands, pollInterval, latency, timeout;
+    };
+
+    Benchmark(const Options &options, QObject *parent = nullptr);
+    ~Benchmark(void);
+
+    bool start(void);
+
+private:
+
+    enum class Stage
+    {
+        startup,
+        commands,
+        results
+    };
+
+    Options m_options;
+    Broker *m_broker;
+    QProcess *m_process;
+    QTimer *m_timer;
+    QTemporaryDir m_directory;
+    QElapsedTimer m_elapsed;
+
+    Stage m_stage;
+    int m_round, m_sent, m_lost;
+    qint64 m_duration;
+
+    QMap <QString, QString> m_status;
+    QMap <QString, qint64> m_pending;
+    QList <qint64> m_samples;
+    QJsonObject m_service, m_statistics;
+
+    bool writeConfig(const QString &configFile);
+    void startRound(void);
+    void finish(bool success);
+
+private slots:
+
+    void messageReceived(const QString &topic, const QByteArray &message);
+    void timeout(void);
+
+};
+
+#endif
@@ -0,0 +1,12 @@
+HEADERS += \
+    benchmark.h \
+    broker.h
+
+SOURCES += \
+    benchmark.cpp \
+    broker.cpp \
+    main.cpp
+
+QT -= gui
+QT += network
+CONFIG += console
@@ -0,0 +1,209 @@
+#include <QtEndian>
+#include "broker.h"
+
+bool Broker::listen(quint16 port)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &Broker::newConnection);
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+void Broker::publish(const QString &topic, const QByteArray &message, bool retain)
+{
+    if (retain)
+    {
+        if (message.isEmpty())
+            m_retained.remove(topic);
+        else
+            m_retained.insert(topic, message);
+    }
+
+    for (auto it = m_clients.begin(); it != m_clients.end(); it++)
+    {
+        for (int i = 0; i < it.value().subscriptions.count(); i++)
+        {
+            if (!match(it.value().subscriptions.at(i), topic))
+                continue;
+
+            deliver(it.key(), topic, message, false);
+            break;
+        }
+    }
+
+    emit messageReceived(topic, message);
+}
+
+bool Broker::match(const QString &filter, const QString &topic)
+{
+    QList <QString> filterLevels = filter.split('/'), topicLevels = topic.split('/');
+
+    for (int i = 0; i < filterLevels.count(); i++)
+    {
+        if (filterLevels.at(i) == "#")
+            return true;
+
+        if (i >= topicLevels.count() || (filterLevels.at(i) != "+" && filterLevels.at(i) != topicLevels.at(i)))
+            return false;
+    }
+
+    return filterLevels.count() == topicLevels.count();
+}
+
+void Broker::send(QTcpSocket *socket, quint8 type, const QByteArray &data)
+{
+    QByteArray packet(1, static_cast <char> (type));
+    int length = data.length();
+
+    do
+    {
+        quint8 value = length % 128;
+        length /= 128;
+        packet.append(static_cast <char> (length ? value | 0x80 : value));
+    }
+    while (length);
+
+    socket->write(packet.append(data));
+}
+
+void Broker::deliver(QTcpSocket *socket, const QString &topic, const QByteArray &message, bool retain)
+{
+    QByteArray name = topic.toUtf8();
+    quint16 length = qToBigEndian <quint16> (static_cast <quint16> (name.length()));
+    send(socket, retain ? 0x31 : 0x30, QByteArray(reinterpret_cast <char*> (&length), sizeof(length)).append(name).append(message));
+}
+
+void Broker::handlePacket(QTcpSocket *socket, quint8 type, const QByteArray &data)
+{
+    switch (type >> 4)
+    {
+        case 1: // CONNECT
+            send(socket, 0x20, QByteArray(2, 0x00));
+            break;
+
+        case 3: // PUBLISH
+        {
+            quint8 qos = type >> 1 & 0x03;
+            int offset;
+
+            if (data.length() < 2)
+                break;
+
+            offset = 2 + qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (data.constData())));
+
+            if (qos)
+            {
+                send(socket, qos == 1 ? 0x40 : 0x50, data.mid(offset, 2));
+                offset += 2;
+            }
+
+            publish(QString::fromUtf8(data.mid(2, offset - (qos ? 4 : 2))), data.mid(offset), type & 0x01);
+            break;
+        }
+
+        case 6: // PUBREL
+            send(socket, 0x70, data.left(2));
+            break;
+
+        case 8: // SUBSCRIBE
+        {
+            QByteArray granted;
+            QList <QString> filters;
+            int offset = 2;
+
+            while (offset + 2 <= data.length())
+            {
+                int length = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (data.constData() + offset)));
+                filters.append(QString::fromUtf8(data.mid(offset + 2, length)));
+                granted.append(static_cast <char> (0x00));
+                offset += length + 3;
+            }
+
+            m_clients[socket].subscriptions.append(filters);
+            send(socket, 0x90, data.left(2).append(granted));
+
+            for (auto it = m_retained.begin(); it != m_retained.end(); it++)
+                for (int i = 0; i < filters.count(); i++)
+                    if (match(filters.at(i), it.key()))
+                        deliver(socket, it.key(), it.value(), true);
+
+            break;
+        }
+
+        case 10: // UNSUBSCRIBE
+        {
+            int offset = 2;
+
+            while (offset + 2 <= data.length())
+            {
+                int length = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (data.constData() + offset)));
+                m_clients[socket].subscriptions.removeAll(QString::fromUtf8(data.mid(offset + 2, length)));
+                offset += length + 2;
+            }
+
+            send(socket, 0xB0, data.left(2));
+            break;
+        }
+
+        case 12: // PINGREQ
+            send(socket, 0xD0);
+            break;
+
+        case 14: // DISCONNECT
+            socket->disconnectFromHost();
+            break;
+    }
+}
+
+void Broker::newConnection(void)
+{
+    while (m_server->hasPendingConnections())
+    {
+        QTcpSocket *socket = m_server->nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, this, &Broker::disconnected);
+        connect(socket, &QTcpSocket::readyRead, this, &Broker::readyRead);
+        m_clients.insert(socket, Client());
+    }
+}
+
+void Broker::disconnected(void)
+{
+    QTcpSocket *socket = reinterpret_cast <QTcpSocket*> (sender());
+    m_clients.remove(socket);
+    socket->deleteLater();
+}
+
+void Broker::readyRead(void)
+{
+    QTcpSocket *socket = reinterpret_cast <QTcpSocket*> (sender());
+
+    m_clients[socket].buffer.append(socket->readAll());
+
+    while (m_clients.contains(socket) && m_clients.value(socket).buffer.length() >= 2)
+    {
+        QByteArray buffer = m_clients.value(socket).buffer;
+        int length = 0, offset = 1;
+        quint8 value;
+
+        do
+        {
+            if (offset > 4)
+            {
+                socket->abort();
+                return;
+            }
+
+            if (offset >= buffer.length())
+                return;
+
+            value = static_cast <quint8> (buffer.at(offset));
+            length |= (value & 0x7F) << 7 * (offset - 1);
+            offset++;
+        }
+        while (value & 0x80);
+
+        if (buffer.length() < offset + length)
+            return;
+
+        m_clients[socket].buffer.remove(0, offset + length);
+        handlePacket(socket, static_cast <quint8> (buffer.at(0)), buffer.mid(offset, length));
+    }
+}
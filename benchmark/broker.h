@@ -0,0 +1,47 @@
+#ifndef BROKER_H
+#define BROKER_H
+
+#include <QTcpServer>
+#include <QTcpSocket>
+
+class Broker : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    Broker(QObject *parent) : QObject(parent), m_server(new QTcpServer(this)) {}
+
+    bool listen(quint16 port);
+    void publish(const QString &topic, const QByteArray &message, bool retain = false);
+
+private:
+
+    struct Client
+    {
+        QByteArray buffer;
+        QList <QString> subscriptions;
+    };
+
+    QTcpServer *m_server;
+    QMap <QTcpSocket*, Client> m_clients;
+    QMap <QString, QByteArray> m_retained;
+
+    bool match(const QString &filter, const QString &topic);
+    void send(QTcpSocket *socket, quint8 type, const QByteArray &data = QByteArray());
+    void deliver(QTcpSocket *socket, const QString &topic, const QByteArray &message, bool retain);
+    void handlePacket(QTcpSocket *socket, quint8 type, const QByteArray &data);
+
+private slots:
+
+    void newConnection(void);
+    void disconnected(void);
+    void readyRead(void);
+
+signals:
+
+    void messageReceived(const QString &topic, const QByteArray &message);
+
+};
+
+#endif
@@ -0,0 +1,36 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include "benchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCommandLineParser parser;
+    Benchmark::Options options;
+
+    parser.setApplicationDescription("Runs homed-modbus against the built-in simulator and a local MQTT broker stand-in, then prints the results as JSON.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("service", "Path to the homed-modbus binary.");
+    parser.addOptions({{"devices", "Number of devices on the simulated port.", "count", "16"}, {"commands", "Number of toggle rounds sent to every device.", "count", "10"}, {"type", "Device type used for every device.", "type", "wbMr6"}, {"poll", "Device poll interval in milliseconds.", "ms", "1000"}, {"latency", "Simulator reply latency in milliseconds.", "ms", "10"}, {"timeout", "Round timeout in milliseconds.", "ms", "5000"}, {"port", "Broker stand-in TCP port.", "port", "18830"}, {"expose", "Path to the expose.json file.", "file"}});
+    parser.process(application);
+
+    if (parser.positionalArguments().isEmpty())
+        parser.showHelp(EXIT_FAILURE);
+
+    options.service = parser.positionalArguments().value(0);
+    options.type = parser.value("type");
+    options.expose = parser.value("expose");
+    options.port = static_cast <quint16> (parser.value("port").toInt());
+    options.devices = qBound(1, parser.value("devices").toInt(), 247);
+    options.commands = parser.value("commands").toInt();
+    options.pollInterval = parser.value("poll").toInt();
+    options.latency = parser.value("latency").toInt();
+    options.timeout = parser.value("timeout").toInt();
+
+    Benchmark benchmark(options);
+
+    if (!benchmark.start())
+        return EXIT_FAILURE;
+
+    return application.exec();
+}
@@ -1,3 +1,5 @@
+#include <sys/resource.h>
+#include <QTextStream>
 #include "controller.h"
 #include "device.h"
 #include "logger.h"
@@ -16,13 +18,28 @@ Controller::Controller(const QString &configFile) : HOMEd(SERVICE_VERSION, confi
     m_timer->setSingleShot(true);
     m_devices->init();
 
-    for (int i = 0; i < m_devices->count(); i++)
+    if (QCoreApplication::arguments().contains("--capacity"))
     {
-        const Device &device = m_devices->at(i);
-        connect(device.data(), &DeviceObject::deviceUpdated, this, &Controller::deviceUpdated);
-        connect(device.data(), &DeviceObject::endpointUpdated, this, &Controller::endpointUpdated);
+        QJsonObject json;
+
+        for (int i = 0; i < keys.count(); i++)
+        {
+            const QString &key = keys.at(i);
+
+            if (!QRegExp("^port-\\d+$").exactMatch(key))
+                continue;
+
+            json.insert(key, PortThread::capacity(static_cast <quint8> (key.split('-').value(1).toInt()), *m_devices, getConfig()->value(QString("%1/tcp").arg(key), false).toBool()));
+        }
+
+        QTextStream(stdout) << QJsonDocument(json).toJson();
+        QTimer::singleShot(0, QCoreApplication::instance(), &QCoreApplication::quit);
+        return;
     }
 
+    if (getConfig()->value("simulator/enabled", false).toBool())
+        m_simulator = Simulator(new SimulatorThread(getConfig()));
+
     for (int i = 0; i < keys.count(); i++)
     {
         const QString &key = keys.at(i);
@@ -30,11 +47,41 @@ Controller::Controller(const QString &configFile) : HOMEd(SERVICE_VERSION, confi
         if (QRegExp("^port-\\d+$").exactMatch(key))
         {
             quint8 id = static_cast <quint8> (key.split('-').value(1).toInt());
-            Port port(new PortThread(id, getConfig()->value(QString("%1/port").arg(key)).toString(), getConfig()->value(QString("%1/tcp").arg(key), false).toBool(), getConfig()->value(QString("%1/rfc").arg(key), false).toBool(), getConfig()->value(QString("%1/debug").arg(key), false).toBool(), m_devices));
+            Port port(new PortThread(id, getConfig(), m_devices));
             connect(port.data(), &PortThread::updateAvailability, this, &Controller::updateAvailability);
+            connect(port.data(), &PortThread::statisticsUpdated, this, &Controller::updateStatistics);
+            connect(port.data(), &PortThread::capacityUpdated, this, &Controller::updateCapacity);
+            connect(port.data(), &PortThread::scanUpdated, this, &Controller::updateScan);
             m_ports.insert(id, port);
         }
     }
+
+    for (int i = 0; i < m_devices->count(); i++)
+        attachDevice(m_devices->at(i));
+
+    for (auto it = m_ports.begin(); it != m_ports.end(); it++)
+        it.value()->start();
+}
+
+void Controller::attachDevice(const Device &device)
+{
+    Port port = m_ports.value(device->portId());
+
+    connect(device.data(), &DeviceObject::deviceUpdated, this, &Controller::deviceUpdated);
+    connect(device.data(), &DeviceObject::endpointUpdated, this, &Controller::endpointUpdated);
+    connect(device.data(), &DeviceObject::endpointEvent, this, &Controller::endpointEvent);
+
+    if (port.isNull())
+        return;
+
+    device->moveToThread(port.data());
+}
+
+void Controller::detachDevice(const Device &device)
+{
+    disconnect(device.data(), &DeviceObject::deviceUpdated, this, &Controller::deviceUpdated);
+    disconnect(device.data(), &DeviceObject::endpointUpdated, this, &Controller::endpointUpdated);
+    disconnect(device.data(), &DeviceObject::endpointEvent, this, &Controller::endpointEvent);
 }
 
 void Controller::publishExposes(DeviceObject *device, bool remove)
@@ -49,8 +96,7 @@ void Controller::publishExposes(DeviceObject *device, bool remove)
 
 void Controller::publishProperties(DeviceObject *device)
 {
-    for (auto it = device->endpoints().begin(); it != device->endpoints().end(); it++)
-        endpointUpdated(device, it.key());
+    QMetaObject::invokeMethod(device, [device] () { device->publishStatus(); }, Qt::QueuedConnection);
 }
 
 void Controller::publishEvent(const QString &name, Event event)
@@ -89,6 +135,36 @@ void Controller::deviceEvent(DeviceObject *device, Event event)
     publishEvent(device->name(), event);
 }
 
+void Controller::publishBenchmark(void)
+{
+    QJsonObject json;
+    struct rusage usage;
+    qint64 cpu;
+    int count = 0;
+
+    for (int i = 0; i < m_devices->count(); i++)
+        if (m_devices->at(i)->active())
+            count++;
+
+    getrusage(RUSAGE_SELF, &usage);
+    cpu = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+
+    json.insert("devices", count);
+    json.insert("cpu", cpu);
+    json.insert("memory", static_cast <qint64> (usage.ru_maxrss));
+
+    if (count)
+    {
+        json.insert("cpuPerDevice", static_cast <double> (cpu) / count);
+        json.insert("memoryPerDevice", static_cast <double> (usage.ru_maxrss) / count);
+    }
+
+    if (m_latency.count())
+        json.insert("latency", m_latency.json());
+
+    mqttPublish(mqttTopic("benchmark/%1").arg(serviceTopic()), json);
+}
+
 void Controller::quit(void)
 {
     for (auto it = m_ports.begin(); it != m_ports.end(); it++)
@@ -97,6 +173,12 @@ void Controller::quit(void)
         it.value()->wait();
     }
 
+    if (!m_simulator.isNull())
+    {
+        m_simulator->quit();
+        m_simulator->wait();
+    }
+
     delete m_devices;
     HOMEd::quit();
 }
@@ -116,7 +198,7 @@ void Controller::mqttConnected(void)
     }
 
     for (int i = 0; i < m_devices->count(); i++)
-        updateAvailability(m_devices->at(i).data());
+        updateAvailability(m_devices->at(i));
 
     m_devices->store();
     mqttPublishService();
@@ -153,9 +235,14 @@ void Controller::mqttReceived(const QByteArray &message, const QMqttTopicName &t
                     break;
                 }
 
+                QString previous = device.isNull() ? QString() : device->name();
+
                 if (!device.isNull() && device->name() != name)
                     deviceEvent(device.data(), Event::aboutToRename);
 
+                if (!device.isNull())
+                    m_commandTime.remove(device.data());
+
                 device = m_devices->parse(data);
 
                 if (device.isNull())
@@ -165,22 +252,28 @@ void Controller::mqttReceived(const QByteArray &message, const QMqttTopicName &t
                     break;
                 }
 
+                if (!previous.isEmpty() && previous != device->name())
+                    for (auto it = m_devices->groups().begin(); it != m_devices->groups().end(); it++)
+                        for (int i = 0; i < it.value().count(); i++)
+                            if (it.value().at(i) == previous)
+                                it.value().replace(i, device->name());
+
+                attachDevice(device);
+
                 if (index >= 0)
                 {
-                    m_devices->replace(index, device);
+                    detachDevice(m_devices->at(index));
+                    m_devices->replaceDevice(index, device);
                     logInfo << device << "successfully updated";
                     deviceEvent(device.data(), Event::updated);
                 }
                 else
                 {
-                    m_devices->append(device);
+                    m_devices->appendDevice(device);
                     logInfo << device << "successfully added";
                     deviceEvent(device.data(), Event::added);
                 }
 
-                connect(device.data(), &DeviceObject::deviceUpdated, this, &Controller::deviceUpdated);
-                connect(device.data(), &DeviceObject::endpointUpdated, this, &Controller::endpointUpdated);
-
                 m_devices->store(true);
                 break;
             }
@@ -192,10 +285,13 @@ void Controller::mqttReceived(const QByteArray &message, const QMqttTopicName &t
 
                 if (index >= 0)
                 {
-                    disconnect(device.data(), &DeviceObject::deviceUpdated, this, &Controller::deviceUpdated);
-                    disconnect(device.data(), &DeviceObject::endpointUpdated, this, &Controller::endpointUpdated);
+                    detachDevice(device);
+
+                    for (auto it = m_devices->groups().begin(); it != m_devices->groups().end(); it++)
+                        it.value().removeAll(device->name());
 
-                    m_devices->removeAt(index);
+                    m_commandTime.remove(device.data());
+                    m_devices->removeDevice(index);
                     logInfo << device << "removed";
                     deviceEvent(device.data(), Event::removed);
                     m_devices->store(true);
@@ -213,22 +309,147 @@ void Controller::mqttReceived(const QByteArray &message, const QMqttTopicName &t
 
                 break;
             }
+
+            case Command::getStatistics:
+            {
+                for (auto it = m_ports.begin(); it != m_ports.end(); it++)
+                {
+                    if (json.contains("port") && json.value("port").toInt() != it.key())
+                        continue;
+
+                    QMetaObject::invokeMethod(it.value().data(), &PortThread::publishStatistics, Qt::QueuedConnection);
+                }
+
+                break;
+            }
+
+            case Command::getCapacity:
+            {
+                for (auto it = m_ports.begin(); it != m_ports.end(); it++)
+                {
+                    if (json.contains("port") && json.value("port").toInt() != it.key())
+                        continue;
+
+                    QMetaObject::invokeMethod(it.value().data(), &PortThread::publishCapacity, Qt::QueuedConnection);
+                }
+
+                break;
+            }
+
+            case Command::updateGroup:
+            {
+                QString name = mqttSafe(json.value("group").toString());
+                QJsonArray array = json.value("devices").toArray();
+                QList <QString> list;
+
+                for (auto it = array.begin(); it != array.end(); it++)
+                {
+                    Device device = m_devices->byName(it->toString());
+
+                    if (device.isNull())
+                    {
+                        logWarning << "Group" << name << "device" << it->toString() << "not found";
+                        continue;
+                    }
+
+                    list.append(device->name());
+                }
+
+                if (name.isEmpty() || list.isEmpty())
+                {
+                    logWarning << "Group" << name << "update failed, data is incomplete";
+                    break;
+                }
+
+                m_devices->groups().insert(name, list);
+                logInfo << "Group" << name << "successfully updated";
+                m_devices->store(true);
+                break;
+            }
+
+            case Command::removeGroup:
+            {
+                QString name = mqttSafe(json.value("group").toString());
+
+                if (!m_devices->groups().remove(name))
+                    break;
+
+                logInfo << "Group" << name << "removed";
+                m_devices->store(true);
+                break;
+            }
+
+            case Command::getBenchmark:
+            {
+                publishBenchmark();
+                break;
+            }
+
+            case Command::scanFastModbus:
+            {
+                for (auto it = m_ports.begin(); it != m_ports.end(); it++)
+                {
+                    if (json.contains("port") && json.value("port").toInt() != it.key())
+                        continue;
+
+                    QMetaObject::invokeMethod(it.value().data(), "scanFastModbus", Qt::QueuedConnection, Q_ARG(bool, json.value("resolve").toBool()), Q_ARG(qint32, json.value("baudRate").toInt(9600)));
+                }
+
+                break;
+            }
+
+            case Command::scanPort:
+            {
+                Port port = m_ports.value(static_cast <quint8> (json.value("port").toInt()));
+
+                if (port.isNull())
+                    break;
+
+                QMetaObject::invokeMethod(port.data(), "scanPort", Qt::QueuedConnection, Q_ARG(QJsonObject, json));
+                break;
+            }
         }
     }
     else if (subTopic.startsWith(QString("td/%1/").arg(serviceTopic())))
     {
         QList <QString> list = subTopic.remove(QString("td/%1/").arg(serviceTopic())).split('/');
-        Device device = m_devices->byName(list.value(0));
+        QList <Device> devices;
 
-        if (device.isNull() || !device->active())
-            return;
+        if (list.value(0) == "group" && m_devices->groups().contains(list.value(1)))
+        {
+            devices = m_devices->byGroup(list.value(1));
+            list.removeFirst();
+        }
+        else
+            devices.append(m_devices->byName(list.value(0)));
 
-        for (auto it = json.begin(); it != json.end(); it++)
+        for (int i = 0; i < devices.count(); i++)
         {
-            if (!it.value().toVariant().isValid())
+            const Device &device = devices.at(i);
+
+            if (device.isNull() || !device->active())
+                continue;
+
+            Port port = m_ports.value(device->portId());
+            qint64 time = QDateTime::currentMSecsSinceEpoch();
+
+            if (port.isNull())
                 continue;
 
-            device->enqueueAction(static_cast <quint8> (list.value(1).toInt()), it.key(), it.value().toVariant());
+            for (auto it = json.begin(); it != json.end(); it++)
+            {
+                QMap <QString, qint64> &commands = m_commandTime[device.data()];
+                QString key = QString("%1/%2").arg(list.value(1).toInt()).arg(it.key());
+
+                if (!it.value().toVariant().isValid())
+                    continue;
+
+                if (time - commands.value(key) > BENCHMARK_TIMEOUT)
+                    commands.insert(key, time);
+
+                if (!port->enqueueAction(device, static_cast <quint8> (list.value(1).toInt()), it.key(), it.value().toVariant(), time))
+                    logWarning << device << "action" << it.key() << "dropped, port" << port->portId() << (port->sniffer() ? "is in sniffer mode" : "action queue is full");
+            }
         }
     }
     else if (topic.name() == m_haStatus)
@@ -240,7 +461,7 @@ void Controller::mqttReceived(const QByteArray &message, const QMqttTopicName &t
     }
 }
 
-void Controller::updateAvailability(DeviceObject *device)
+void Controller::updateAvailability(const Device &device)
 {
     QString status = device->availability() == Availability::Online ? "online" : "offline";
     mqttPublish(mqttTopic("device/%1/%2").arg(serviceTopic(), m_devices->names() ? device->name() : device->address()), {{"status", status}}, true);
@@ -260,23 +481,73 @@ void Controller::updateProperties(void)
     }
 }
 
-void Controller::deviceUpdated(DeviceObject *device)
+void Controller::updateStatistics(quint8 portId, const QJsonObject &json)
+{
+    mqttPublish(mqttTopic("statistics/%1/%2").arg(serviceTopic()).arg(portId), json);
+}
+
+void Controller::updateCapacity(quint8 portId, const QJsonObject &json)
+{
+    mqttPublish(mqttTopic("capacity/%1/%2").arg(serviceTopic()).arg(portId), json);
+}
+
+void Controller::updateScan(quint8 portId, const QJsonObject &json)
+{
+    mqttPublish(mqttTopic("scan/%1/%2").arg(serviceTopic()).arg(portId), json);
+}
+
+void Controller::deviceUpdated(const Device &device)
 {
     logInfo << device->name() << "successfully updated";
     m_devices->store(true);
 }
 
-void Controller::endpointUpdated(DeviceObject *device, quint8 endpointId)
+void Controller::commandFinished(DeviceObject *device, quint8 endpointId, const QString &property)
 {
-    Endpoint endpoint = device->endpoints().value(endpointId);
+    auto it = m_commandTime.find(device);
+    qint64 elapsed;
+
+    if (it == m_commandTime.end() || !it.value().contains(QString("%1/%2").arg(endpointId).arg(property)))
+        return;
+
+    elapsed = QDateTime::currentMSecsSinceEpoch() - it.value().take(QString("%1/%2").arg(endpointId).arg(property));
+
+    if (it.value().isEmpty())
+        m_commandTime.erase(it);
 
-    if (!endpoint->status().isEmpty())
+    if (elapsed <= BENCHMARK_TIMEOUT)
+        m_latency.append(elapsed);
+}
+
+void Controller::endpointUpdated(const Device &device, quint8 endpointId, const QMap <QString, QVariant> &status, const QList <QString> &changed)
+{
+    if (!status.isEmpty())
     {
         QString topic = mqttTopic("fd/%1/%2").arg(serviceTopic(), m_devices->names() ? device->name() : device->address());
 
         if (endpointId)
             topic.append(QString("/%1").arg(endpointId));
 
-        mqttPublish(topic, QJsonObject::fromVariantMap(endpoint->status()));
+        mqttPublish(topic, QJsonObject::fromVariantMap(status));
     }
+
+    if (!m_commandTime.contains(device.data()))
+        return;
+
+    for (int i = 0; i < changed.count(); i++)
+        commandFinished(device.data(), endpointId, changed.at(i));
+}
+
+void Controller::endpointEvent(const Device &device, quint8 endpointId, const QMap <QString, QVariant> &status, const QString &name, const QVariant &value)
+{
+    QString topic = mqttTopic("fd/%1/%2").arg(serviceTopic(), m_devices->names() ? device->name() : device->address());
+    QJsonObject json = QJsonObject::fromVariantMap(status);
+
+    if (endpointId)
+        topic.append(QString("/%1").arg(endpointId));
+
+    json.insert(name, QJsonValue::fromVariant(value));
+
+    mqttPublish(topic, json);
+    commandFinished(device.data(), endpointId, name);
 }
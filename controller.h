@@ -3,10 +3,12 @@
 
 #define SERVICE_VERSION             "2.2.1"
 #define UPDATE_PROPERTIES_DELAY     1000
+#define BENCHMARK_TIMEOUT           10000
 
 #include <QMetaEnum>
 #include "homed.h"
 #include "port.h"
+#include "simulator.h"
 
 class Controller : public HOMEd
 {
@@ -19,7 +21,14 @@ public:
         restartService,
         updateDevice,
         removeDevice,
-        getProperties
+        getProperties,
+        getStatistics,
+        getCapacity,
+        updateGroup,
+        removeGroup,
+        getBenchmark,
+        scanFastModbus,
+        scanPort
     };
 
     enum class Event
@@ -42,15 +51,24 @@ private:
     QTimer *m_timer;
     DeviceList *m_devices;
     QMap <quint8, Port> m_ports;
+    Simulator m_simulator;
+
+    QMap <DeviceObject*, QMap <QString, qint64>> m_commandTime;
+    Latency m_latency;
 
     QMetaEnum m_commands, m_events;
     QString m_haPrefix, m_haStatus;
     bool m_haEnabled, m_haUpdate;
 
+    void attachDevice(const Device &device);
+    void detachDevice(const Device &device);
+
     void publishExposes(DeviceObject *device, bool remove = false);
     void publishProperties(DeviceObject *device);
     void publishEvent(const QString &name, Event event);
     void deviceEvent(DeviceObject *device, Event event);
+    void publishBenchmark(void);
+    void commandFinished(DeviceObject *device, quint8 endpointId, const QString &property);
 
 public slots:
 
@@ -61,11 +79,15 @@ private slots:
     void mqttConnected(void) override;
     void mqttReceived(const QByteArray &message, const QMqttTopicName &topic) override;
 
-    void updateAvailability(DeviceObject *device);
+    void updateAvailability(const Device &device);
     void updateProperties(void);
+    void updateStatistics(quint8 portId, const QJsonObject &json);
+    void updateCapacity(quint8 portId, const QJsonObject &json);
+    void updateScan(quint8 portId, const QJsonObject &json);
 
-    void deviceUpdated(DeviceObject *device);
-    void endpointUpdated(DeviceObject *device, quint8 endpointId);
+    void deviceUpdated(const Device &device);
+    void endpointUpdated(const Device &device, quint8 endpointId, const QMap <QString, QVariant> &status, const QList <QString> &changed);
+    void endpointEvent(const Device &device, quint8 endpointId, const QMap <QString, QVariant> &status, const QString &name, const QVariant &value);
 
 };
 
@@ -1,3 +1,5 @@
+#include <QThread>
+#include <QtEndian>
 #include "devices/custom.h"
 #include "devices/eletechsup.h"
 #include "devices/kincony.h"
@@ -20,6 +22,242 @@ DeviceObject::~DeviceObject(void)
     delete m_modbus;
 }
 
+void DeviceObject::destroy(DeviceObject *device)
+{
+    QThread *thread = device->thread();
+
+    if (thread != QThread::currentThread() && thread->isRunning())
+    {
+        device->deleteLater();
+        return;
+    }
+
+    delete device;
+}
+
+void DeviceObject::updateRtt(qint64 value)
+{
+    if (!m_rtt)
+    {
+        m_rtt = value;
+        m_rttVariance = value / 2.0;
+        return;
+    }
+
+    m_rttVariance = 0.75 * m_rttVariance + 0.25 * qAbs(m_rtt - value);
+    m_rtt = 0.875 * m_rtt + 0.125 * value;
+}
+
+QList <QByteArray> DeviceObject::pollProgram(QList <quint8> *sequence)
+{
+    QList <QByteArray> list;
+    QMap <quint8, QMap <QString, QVariant>> buffers;
+    QMap <quint8, qint64> stepTimes = m_stepTimes;
+    qint64 pollTime = m_pollTime;
+    quint64 stepMask = m_stepMask;
+    quint8 current = m_sequence;
+    bool polling = m_polling, fullPoll = m_fullPoll;
+
+    for (auto it = m_endpoints.begin(); it != m_endpoints.end(); it++)
+        buffers.insert(it.key(), it.value()->buffer());
+
+    m_stepTimes.clear();
+    m_program = true;
+    m_polling = false;
+    m_fullPoll = false;
+
+    startPoll();
+
+    while (list.count() < MAX_PROGRAM_LENGTH)
+    {
+        QByteArray request = pollRequest();
+
+        if (request.isEmpty())
+            break;
+
+        list.append(request);
+
+        if (sequence)
+            sequence->append(m_sequence);
+
+        m_sequence++;
+    }
+
+    for (auto it = m_endpoints.begin(); it != m_endpoints.end(); it++)
+        it.value()->buffer() = buffers.value(it.key());
+
+    m_program = false;
+    m_stepTimes = stepTimes;
+    m_stepMask = stepMask;
+    m_pollTime = pollTime;
+    m_sequence = current;
+    m_polling = polling;
+    m_fullPoll = fullPoll;
+
+    return list;
+}
+
+bool DeviceObject::parseCapture(const QByteArray &request, const QByteArray &reply)
+{
+    int index;
+
+    if (m_captureProgram.isEmpty())
+        m_captureProgram = pollProgram(&m_captureSequence);
+
+    index = m_captureProgram.indexOf(request);
+
+    if (index < 0)
+        return false;
+
+    m_sequence = m_captureSequence.at(index);
+    parseReply(reply);
+    updateEndpoints();
+
+    return true;
+}
+
+void CounterDecoder::setup(const QList <Input> &inputs, const QList <QString> &actions)
+{
+    m_inputs = inputs;
+    m_actions = actions;
+    m_values.fill(0, m_inputs.count() * m_actions.count());
+}
+
+quint32 CounterDecoder::update(quint8 block, const quint16 *data)
+{
+    quint16 *values;
+    quint32 mask = 0;
+
+    if (block >= m_actions.count())
+        return 0;
+
+    values = m_values.data() + block * m_inputs.count();
+
+    if (!memcmp(values, data, m_inputs.count() * sizeof(quint16)))
+        return 0;
+
+    for (int i = 0; i < m_inputs.count(); i++)
+        if (values[i] != data[i])
+            mask |= 1 << i;
+
+    memcpy(values, data, m_inputs.count() * sizeof(quint16));
+    return mask;
+}
+
+bool CounterDecoder::update(quint8 block, quint8 index, quint16 value)
+{
+    quint16 *values;
+
+    if (block >= m_actions.count() || index >= m_inputs.count())
+        return false;
+
+    values = m_values.data() + block * m_inputs.count();
+
+    if (values[index] == value)
+        return false;
+
+    values[index] = value;
+    return true;
+}
+
+void DeviceObject::parseCounters(quint8 block, const quint16 *data)
+{
+    quint32 mask = m_counters.update(block, data);
+
+    if (m_fullPoll)
+        return;
+
+    for (int i = 0; mask; i++, mask >>= 1)
+    {
+        const CounterDecoder::Input &input = m_counters.input(i);
+
+        if (!(mask & 1) || input.key.isEmpty())
+            continue;
+
+        publishEvent(input.endpointId, input.key, m_counters.action(block));
+    }
+}
+
+void DeviceObject::parseCounterEvent(quint16 offset, const QByteArray &data)
+{
+    quint8 block = static_cast <quint8> (offset / 0x10), index = static_cast <quint8> (offset % 0x10);
+
+    if (data.length() < 2 || !m_counters.update(block, index, qFromLittleEndian <quint16> (*(reinterpret_cast <const quint16*> (data.constData())))))
+        return;
+
+    const CounterDecoder::Input &input = m_counters.input(index);
+
+    if (input.key.isEmpty())
+        return;
+
+    publishEvent(input.endpointId, input.key, m_counters.action(block));
+}
+
+void DeviceObject::startSteps(void)
+{
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+
+    m_stepMask = 0;
+
+    for (auto it = m_stepIntervals.begin(); it != m_stepIntervals.end(); it++)
+    {
+        if (!m_fullPoll && m_stepTimes.value(it.key()) + it.value() > time)
+        {
+            m_stepMask |= 1ULL << it.key();
+            continue;
+        }
+
+        m_stepTimes.insert(it.key(), time);
+    }
+}
+
+void DeviceObject::skipSteps(quint8 count)
+{
+    while (m_sequence < count && m_sequence < 64 && m_stepMask & 1ULL << m_sequence)
+        m_sequence++;
+}
+
+void DeviceObject::enqueueCoil(quint16 address, bool value)
+{
+    bool batch = !broadcast() && !m_actionQueue.isEmpty() && m_actionQueue.last() == m_coilsRequest;
+    quint16 first, last;
+
+    if (batch)
+    {
+        first = m_pendingCoils.firstKey();
+        last = m_pendingCoils.lastKey();
+        batch = address + 1 >= first && address <= last + 1 && qMax(last, address) - qMin(first, address) < MAX_BATCH_COILS;
+    }
+
+    if (!batch)
+        m_pendingCoils.clear();
+
+    m_pendingCoils.insert(address, value);
+
+    first = m_pendingCoils.firstKey();
+    last = m_pendingCoils.lastKey();
+
+    if (first == last)
+        m_coilsRequest = m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleCoil, address, value ? 0xFF00 : 0x0000);
+    else
+    {
+        quint16 data[MAX_BATCH_COILS];
+
+        for (quint16 i = first; i <= last; i++)
+            data[i - first] = m_pendingCoils.value(i) ? 1 : 0;
+
+        m_coilsRequest = m_modbus->makeRequest(m_slaveId, Modbus::WriteMultipleCoils, first, last - first + 1, data);
+    }
+
+    if (batch)
+    {
+        m_actionQueue.last() = m_coilsRequest;
+        return;
+    }
+
+    m_actionQueue.enqueue(m_coilsRequest);
+}
+
 void DeviceObject::updateOptions(const QMap <QString, QVariant> &exposeOptions)
 {
     for (auto it = m_endpoints.begin(); it != m_endpoints.end(); it++)
@@ -38,16 +276,31 @@ void DeviceObject::updateOptions(const QMap <QString, QVariant> &exposeOptions)
 
 void DeviceObject::updateEndpoints(void)
 {
+    if (m_program)
+        return;
+
     for (auto it = m_endpoints.begin(); it != m_endpoints.end(); it++)
     {
+        QList <QString> changed;
+
         if (it.value()->status() == it.value()->buffer())
             continue;
 
+        for (auto item = it.value()->buffer().begin(); item != it.value()->buffer().end(); item++)
+            if (it.value()->status().value(item.key()) != item.value())
+                changed.append(item.key());
+
         it.value()->status() = it.value()->buffer();
-        emit endpointUpdated(this, it.key());
+        emit endpointUpdated(sharedFromThis(), it.key(), it.value()->status(), changed);
     }
 }
 
+void DeviceObject::publishStatus(void)
+{
+    for (auto it = m_endpoints.begin(); it != m_endpoints.end(); it++)
+        emit endpointUpdated(sharedFromThis(), it.key(), it.value()->status(), QList <QString> ());
+}
+
 DeviceList::DeviceList(QSettings *config, QObject *parent) : QObject(parent), m_timer(new QTimer(this)), m_deviceTypes(QMetaEnum::fromType <DeviceType> ()), m_registerTypes(QMetaEnum::fromType <Custom::RegisterType> ()), m_dataTypes(QMetaEnum::fromType <Custom::DataType> ()), m_sync(false)
 {
     QFile file(config->value("device/expose", reinterpret_cast <HOMEd*> (parent)->basePath().append("share/homed-common/expose.json")).toString());
@@ -84,6 +337,7 @@ void DeviceList::init(void)
 
     json = QJsonDocument::fromJson(m_file.readAll()).object();
     unserialize(json.value("devices").toArray());
+    unserializeGroups(json.value("groups").toObject());
     m_file.close();
 }
 
@@ -111,6 +365,48 @@ Device DeviceList::byName(const QString &name, int *index)
     return Device();
 }
 
+QList <Device> DeviceList::snapshot(void)
+{
+    QMutexLocker locker(&m_mutex);
+    return *this;
+}
+
+void DeviceList::appendDevice(const Device &device)
+{
+    QMutexLocker locker(&m_mutex);
+    append(device);
+}
+
+void DeviceList::replaceDevice(int index, const Device &device)
+{
+    QMutexLocker locker(&m_mutex);
+    replace(index, device);
+}
+
+void DeviceList::removeDevice(int index)
+{
+    QMutexLocker locker(&m_mutex);
+    removeAt(index);
+}
+
+QList <Device> DeviceList::byGroup(const QString &name)
+{
+    const QList <QString> &names = m_groups.value(name);
+    QList <Device> list;
+
+    for (int i = 0; i < names.count(); i++)
+    {
+        Device device = byName(names.at(i));
+
+        if (device.isNull() || list.contains(device))
+            continue;
+
+        list.append(device);
+    }
+
+    return list;
+}
+
 Device DeviceList::parse(const QJsonObject &json)
 {
     QString name = mqttSafe(json.value("name").toString());
@@ -118,63 +414,63 @@ Device DeviceList::parse(const QJsonObject &json)
     quint32 baudRate = json.value("baudRate").toInt(), pollInterval = json.value("pollInterval").toInt(), requestTimeout = json.value("requestTimeout").toInt(1000), replyTimeout = json.value("replyTimeout").toInt(20);
     Device device;
 
-    if (name.isEmpty() || !portId || !slaveId || !baudRate)
+    if (name.isEmpty() || !portId || !json.contains("slaveId") || !baudRate)
         return device;
 
     switch (static_cast <DeviceType> (m_deviceTypes.keyToValue(json.value("type").toString().toUtf8().constData())))
     {
-        case DeviceType::customController:      device = Device(new Custom::Controller(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::homedCommon:           device = Device(new Native::Common(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::homedRelayController:  device = Device(new Native::RelayController(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::homedSwitchController: device = Device(new Native::SwitchController(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbCommon:              device = Device(new WirenBoard::Common(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbUps:                 device = Device(new WirenBoard::WBUps(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMwac:                device = Device(new WirenBoard::WBMwac(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbM1w2:                device = Device(new WirenBoard::WBM1w2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMs:                  device = Device(new WirenBoard::WBMs(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMsw:                 device = Device(new WirenBoard::WBMsw(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMai6:                device = Device(new WirenBoard::WBMai6(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMap3ev:              device = Device(new WirenBoard::WBMap3ev(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMap3e:               device = Device(new WirenBoard::WBMap3e(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMap6s:               device = Device(new WirenBoard::WBMap6s(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMap12e:              device = Device(new WirenBoard::WBMap12e(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMap12h:              device = Device(new WirenBoard::WBMap12h(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMrwm2:               device = Device(new WirenBoard::WBMrwm2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMrm2:                device = Device(new WirenBoard::WBMrm2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMr3:                 device = Device(new WirenBoard::WBMr3(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMr6:                 device = Device(new WirenBoard::WBMr6(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMr6p:                device = Device(new WirenBoard::WBMr6p(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbMdm:                 device = Device(new WirenBoard::WBMdm(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed0:                device = Device(new WirenBoard::WBLed0(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed1:                device = Device(new WirenBoard::WBLed1(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed2:                device = Device(new WirenBoard::WBLed2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed16:               device = Device(new WirenBoard::WBLed16(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed17:               device = Device(new WirenBoard::WBLed17(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed18:               device = Device(new WirenBoard::WBLed18(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed32:               device = Device(new WirenBoard::WBLed32(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed33:               device = Device(new WirenBoard::WBLed33(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed34:               device = Device(new WirenBoard::WBLed34(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed256:              device = Device(new WirenBoard::WBLed256(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::wbLed512:              device = Device(new WirenBoard::WBLed512(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::n4dsa02:               device = Device(new Eletechsup::N4Dsa02(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::r4pin08m0:             device = Device(new Eletechsup::R4Pin08M0(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::r4pin08m1:             device = Device(new Eletechsup::R4Pin08M1(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::r4pin08m2:             device = Device(new Eletechsup::R4Pin08M2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::r4pin08m3:             device = Device(new Eletechsup::R4Pin08M3(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::r4pin08m4:             device = Device(new Eletechsup::R4Pin08M4(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a4:               device = Device(new Kincony::KC868A4(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a6:               device = Device(new Kincony::KC868A6(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a8:               device = Device(new Kincony::KC868A8(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a16:              device = Device(new Kincony::KC868A16(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a32:              device = Device(new Kincony::KC868A32(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a64:              device = Device(new Kincony::KC868A64(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::kc868a128:             device = Device(new Kincony::KC868A128(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::pzem0x4:               device = Device(new Peacefair::PZEM0x4(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::pzem6l24:              device = Device(new Peacefair::PZEM6l24(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::neptunSmartPlus:       device = Device(new Neptun::SmartPlus(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::jth2d1:                device = Device(new Other::JTH2d1(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::t13:                   device = Device(new Other::T13(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
-        case DeviceType::m0701s:                device = Device(new Other::M0701s(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name)); break;
+        case DeviceType::customController:      device = Device(new Custom::Controller(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::homedCommon:           device = Device(new Native::Common(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::homedRelayController:  device = Device(new Native::RelayController(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::homedSwitchController: device = Device(new Native::SwitchController(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbCommon:              device = Device(new WirenBoard::Common(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbUps:                 device = Device(new WirenBoard::WBUps(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMwac:                device = Device(new WirenBoard::WBMwac(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbM1w2:                device = Device(new WirenBoard::WBM1w2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMs:                  device = Device(new WirenBoard::WBMs(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMsw:                 device = Device(new WirenBoard::WBMsw(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMai6:                device = Device(new WirenBoard::WBMai6(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMap3ev:              device = Device(new WirenBoard::WBMap3ev(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMap3e:               device = Device(new WirenBoard::WBMap3e(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMap6s:               device = Device(new WirenBoard::WBMap6s(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMap12e:              device = Device(new WirenBoard::WBMap12e(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMap12h:              device = Device(new WirenBoard::WBMap12h(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMrwm2:               device = Device(new WirenBoard::WBMrwm2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMrm2:                device = Device(new WirenBoard::WBMrm2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMr3:                 device = Device(new WirenBoard::WBMr3(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMr6:                 device = Device(new WirenBoard::WBMr6(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMr6p:                device = Device(new WirenBoard::WBMr6p(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbMdm:                 device = Device(new WirenBoard::WBMdm(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed0:                device = Device(new WirenBoard::WBLed0(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed1:                device = Device(new WirenBoard::WBLed1(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed2:                device = Device(new WirenBoard::WBLed2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed16:               device = Device(new WirenBoard::WBLed16(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed17:               device = Device(new WirenBoard::WBLed17(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed18:               device = Device(new WirenBoard::WBLed18(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed32:               device = Device(new WirenBoard::WBLed32(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed33:               device = Device(new WirenBoard::WBLed33(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed34:               device = Device(new WirenBoard::WBLed34(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed256:              device = Device(new WirenBoard::WBLed256(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::wbLed512:              device = Device(new WirenBoard::WBLed512(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::n4dsa02:               device = Device(new Eletechsup::N4Dsa02(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::r4pin08m0:             device = Device(new Eletechsup::R4Pin08M0(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::r4pin08m1:             device = Device(new Eletechsup::R4Pin08M1(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::r4pin08m2:             device = Device(new Eletechsup::R4Pin08M2(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::r4pin08m3:             device = Device(new Eletechsup::R4Pin08M3(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::r4pin08m4:             device = Device(new Eletechsup::R4Pin08M4(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a4:               device = Device(new Kincony::KC868A4(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a6:               device = Device(new Kincony::KC868A6(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a8:               device = Device(new Kincony::KC868A8(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a16:              device = Device(new Kincony::KC868A16(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a32:              device = Device(new Kincony::KC868A32(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a64:              device = Device(new Kincony::KC868A64(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::kc868a128:             device = Device(new Kincony::KC868A128(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::pzem0x4:               device = Device(new Peacefair::PZEM0x4(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::pzem6l24:              device = Device(new Peacefair::PZEM6l24(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::neptunSmartPlus:       device = Device(new Neptun::SmartPlus(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::jth2d1:                device = Device(new Other::JTH2d1(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::t13:                   device = Device(new Other::T13(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
+        case DeviceType::m0701s:                device = Device(new Other::M0701s(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), &DeviceObject::destroy); break;
     }
 
     if (!device.isNull())
@@ -188,7 +484,17 @@ Device DeviceList::parse(const QJsonObject &json)
         if (json.contains("cloud"))
             device->setCloud(json.value("cloud").toBool());
 
+        if (json.contains("readWrite") && !device->broadcast())
+            device->setReadWrite(json.value("readWrite").toBool());
+
+        if (json.contains("retryCount"))
+            device->setRetryCount(static_cast <quint8> (json.value("retryCount").toInt()));
+
+        if (json.contains("lowPriority"))
+            device->setLowPriority(json.value("lowPriority").toBool());
+
         device->setNote(json.value("note").toString());
+        device->resetCapture();
         device->init(device, m_exposeOptions);
 
         if (device->type() == "customController")
@@ -251,7 +557,7 @@ void DeviceList::unserialize(const QJsonArray &devices)
         if (device.isNull())
             continue;
 
-        append(device);
+        appendDevice(device);
         count++;
     }
 
@@ -259,6 +565,26 @@ void DeviceList::unserialize(const QJsonArray &devices)
         logInfo << count << "devices loaded";
 }
 
+void DeviceList::unserializeGroups(const QJsonObject &groups)
+{
+    for (auto it = groups.begin(); it != groups.end(); it++)
+    {
+        QJsonArray array = it.value().toArray();
+        QList <QString> names;
+
+        for (auto item = array.begin(); item != array.end(); item++)
+            names.append(item->toString());
+
+        if (it.key().isEmpty() || names.isEmpty())
+            continue;
+
+        m_groups.insert(it.key(), names);
+    }
+
+    if (!m_groups.isEmpty())
+        logInfo << m_groups.count() << "groups loaded";
+}
+
 QJsonArray DeviceList::serialize(void)
 {
     QJsonArray array;
@@ -322,6 +648,15 @@ QJsonArray DeviceList::serialize(void)
                 json.insert("options", options);
         }
 
+        if (device->readWrite())
+            json.insert("readWrite", true);
+
+        if (device->retryCount())
+            json.insert("retryCount", device->retryCount());
+
+        if (device->lowPriority())
+            json.insert("lowPriority", true);
+
         if (!device->note().isEmpty())
             json.insert("note", device->note());
 
@@ -331,11 +666,24 @@ QJsonArray DeviceList::serialize(void)
     return array;
 }
 
+QJsonObject DeviceList::serializeGroups(void)
+{
+    QJsonObject json;
+
+    for (auto it = m_groups.begin(); it != m_groups.end(); it++)
+        json.insert(it.key(), QJsonArray::fromStringList(it.value()));
+
+    return json;
+}
+
 void DeviceList::writeDatabase(void)
 {
     HOMEd *homed = reinterpret_cast <HOMEd*> (parent());
     QJsonObject json = {{"devices", serialize()}, {"names", m_names}, {"timestamp", QDateTime::currentSecsSinceEpoch()}, {"version", SERVICE_VERSION}};
 
+    if (!m_groups.isEmpty())
+        json.insert("groups", serializeGroups());
+
     homed->mqttPublishStatus(json);
 
     if (!m_sync)
@@ -3,11 +3,16 @@
 
 #define DEFAULT_ENDPOINT        0
 #define STORE_DATABASE_DELAY    20
+#define MAX_BATCH_COILS         128
+#define MAX_PROGRAM_LENGTH      256
 
 #include <QMetaEnum>
+#include <QMutex>
 #include <QQueue>
 #include "endpoint.h"
+#include "gesture.h"
 #include "modbus.h"
+#include "statistics.h"
 
 class EndpointObject : public AbstractEndpointObject
 {
@@ -25,31 +30,67 @@ private:
 
 };
 
-class DeviceObject : public AbstractDeviceObject
+class CounterDecoder
+{
+
+public:
+
+    struct Input
+    {
+        quint8 endpointId;
+        QString key;
+    };
+
+    inline const Input &input(int index) { return m_inputs.at(index); }
+    inline QString action(quint8 block) { return m_actions.value(block); }
+
+    void setup(const QList <Input> &inputs, const QList <QString> &actions = {"singleClick", "hold", "doubleClick"});
+    quint32 update(quint8 block, const quint16 *data);
+    bool update(quint8 block, quint8 index, quint16 value);
+
+private:
+
+    QList <QString> m_actions;
+    QList <Input> m_inputs;
+    QVector <quint16> m_values;
+
+};
+
+class DeviceObject : public AbstractDeviceObject, public QEnableSharedFromThis <DeviceObject>
 {
     Q_OBJECT
 
 public:
 
     DeviceObject(quint8 portId, quint8 slaveId, quint32 baudRate, quint32 pollInterval, quint32 requestTimeout, quint32 replyTimeout, const QString &name) :
-        AbstractDeviceObject(name), m_modbus(new Modbus), m_portId(portId), m_slaveId(slaveId), m_baudRate(baudRate), m_pollInterval(pollInterval), m_requestTimeout(requestTimeout), m_replyTimeout(replyTimeout), m_pollTime(0), m_errorCount(0), m_sequence(0), m_polling(false), m_fullPoll(true) {}
+        AbstractDeviceObject(name), m_modbus(new Modbus), m_portId(portId), m_slaveId(slaveId), m_baudRate(baudRate), m_pollInterval(pollInterval), m_requestTimeout(requestTimeout), m_replyTimeout(replyTimeout), m_pollTime(0), m_retryTime(0), m_actionTime(0), m_rtt(0), m_rttVariance(0), m_errorCount(0), m_retryCount(0), m_attempts(0), m_sequence(0), m_polling(false), m_fullPoll(true), m_readWrite(false), m_lowPriority(false), m_events(false), m_eventsChecked(false), m_gestures(nullptr), m_stepMask(0), m_program(false) {}
 
     ~DeviceObject(void);
 
+    static void destroy(DeviceObject *device);
+
     virtual void init(const Device &, const QMap <QString, QVariant> &) = 0;
     virtual void enqueueAction(quint8, const QString &, const QVariant &) {}
     virtual void actionFinished(void) {}
+    virtual bool parseAction(const QByteArray &) { return false; }
     virtual void startPoll(void) = 0;
 
     virtual QByteArray pollRequest(void) = 0;
     virtual void parseReply(const QByteArray &) = 0;
 
+    virtual QByteArray probeRequest(void) { return m_modbus->makeRequest(m_slaveId, Modbus::ReadHoldingRegisters, 0x0000, 1); }
+
+    virtual QByteArray subscriptionRequest(void) { return QByteArray(); }
+    virtual void parseEvent(quint8, quint16, const QByteArray &) {}
+
     inline Modbus *modbus(void) { return m_modbus; }
+    inline Statistics &statistics(void) { return m_statistics; }
     inline QString type(void) { return m_type; }
     inline QString address(void) { return QString("%1.%2").arg(m_portId).arg(m_slaveId); }
 
     inline quint8 portId(void) { return m_portId; }
     inline quint8 slaveId(void) { return m_slaveId; }
+    inline bool broadcast(void) { return !m_slaveId; }
     inline qint32 baudRate(void) { return m_baudRate; }
     inline qint32 pollInterval(void) { return m_pollInterval; }
     inline qint32 requestTimeout(void) { return m_requestTimeout; }
@@ -62,33 +103,96 @@ public:
     inline void increaseErrorCount(void) { m_errorCount++; }
     inline void resetErrorCount(void) { m_errorCount = 0; }
 
+    inline qint64 retryTime(void) { return m_retryTime; }
+    inline void setRetryTime(qint64 value) { m_retryTime = value; }
+
+    inline qint64 actionTime(void) { return m_actionTime; }
+    inline void setActionTime(qint64 value) { m_actionTime = value; }
+
+    inline quint8 retryCount(void) { return m_retryCount; }
+    inline void setRetryCount(quint8 value) { m_retryCount = value; }
+
+    inline quint8 increaseAttempts(void) { return ++m_attempts; }
+    inline void resetAttempts(void) { m_attempts = 0; }
+
+    inline double rtt(void) { return m_rtt; }
+    inline double rttVariance(void) { return m_rttVariance; }
+
+    void updateRtt(qint64 value);
+    QList <QByteArray> pollProgram(QList <quint8> *sequence = nullptr);
+    bool parseCapture(const QByteArray &request, const QByteArray &reply);
+
+    inline bool polling(void) { return m_polling; }
     inline bool fullPoll(void) { return m_fullPoll; }
     inline void resetPoll(void) { m_polling = false; m_fullPoll = true; }
 
+    inline bool readWrite(void) { return m_readWrite; }
+    inline void setReadWrite(bool value) { m_readWrite = value; }
+
+    inline bool events(void) { return m_events; }
+    inline void setEvents(bool value) { m_events = value; resetCapture(); }
+
+    inline bool eventsChecked(void) { return m_eventsChecked; }
+    inline void setEventsChecked(bool value) { m_eventsChecked = value; }
+
+    inline bool lowPriority(void) { return m_lowPriority; }
+    inline void setLowPriority(bool value) { m_lowPriority = value; }
+
+    inline void resetCapture(void) { m_captureProgram.clear(); m_captureSequence.clear(); }
+
+    inline quint32 stepInterval(quint8 step) { return m_stepIntervals.value(step); }
+
     inline QQueue <QByteArray> &actionQueue(void) { return m_actionQueue; }
+    inline void setGestures(GestureEngine *value) { m_gestures = value; }
+    inline void publishEvent(quint8 endpointId, const QString &name, const QVariant &value) { emit endpointEvent(sharedFromThis(), endpointId, m_endpoints.value(endpointId)->status(), name, value); }
+
+    void publishStatus(void);
 
 protected:
 
     Modbus *m_modbus;
+    Statistics m_statistics;
     QString m_type, m_address;
 
     quint8 m_portId, m_slaveId;
     quint32 m_baudRate, m_pollInterval, m_requestTimeout, m_replyTimeout;
 
-    qint64 m_pollTime;
+    qint64 m_pollTime, m_retryTime, m_actionTime;
+    double m_rtt, m_rttVariance;
     quint32 m_errorCount;
+    quint8 m_retryCount, m_attempts;
 
     quint8 m_sequence;
-    bool m_polling, m_fullPoll;
+    bool m_polling, m_fullPoll, m_readWrite, m_lowPriority, m_events, m_eventsChecked;
     QQueue <QByteArray> m_actionQueue;
 
+    QMap <quint16, bool> m_pendingCoils;
+    QByteArray m_coilsRequest;
+
+    QList <QByteArray> m_captureProgram;
+    QList <quint8> m_captureSequence;
+
+    GestureEngine *m_gestures;
+    CounterDecoder m_counters;
+
+    QMap <quint8, quint32> m_stepIntervals;
+    QMap <quint8, qint64> m_stepTimes;
+    quint64 m_stepMask;
+    bool m_program;
+
+    void enqueueCoil(quint16 address, bool value);
+    void parseCounters(quint8 block, const quint16 *data);
+    void parseCounterEvent(quint16 offset, const QByteArray &data);
+    void startSteps(void);
+    void skipSteps(quint8 count);
     void updateOptions(const QMap <QString, QVariant> &exposeOptions);
     void updateEndpoints(void);
 
 signals:
 
-    void deviceUpdated(DeviceObject *device);
-    void endpointUpdated(DeviceObject *device, quint8 endpointId);
+    void deviceUpdated(const Device &device);
+    void endpointUpdated(const Device &device, quint8 endpointId, const QMap <QString, QVariant> &status, const QList <QString> &changed);
+    void endpointEvent(const Device &device, quint8 endpointId, const QMap <QString, QVariant> &status, const QString &name, const QVariant &value);
 
 };
 
@@ -158,18 +262,26 @@ public:
     ~DeviceList(void);
 
     inline bool names(void) { return m_names; }
+    inline QMap <QString, QList <QString>> &groups(void) { return m_groups; }
 
     void init(void);
     void store(bool sync = false);
 
     Device byName(const QString &name, int *index = nullptr);
+    QList <Device> byGroup(const QString &name);
     Device parse(const QJsonObject &json);
 
+    QList <Device> snapshot(void);
+    void appendDevice(const Device &device);
+    void replaceDevice(int index, const Device &device);
+    void removeDevice(int index);
+
     Q_ENUM(DeviceType)
 
 private:
 
     QTimer *m_timer;
+    QMutex m_mutex;
 
     QMetaEnum m_deviceTypes, m_registerTypes, m_dataTypes, m_byteOrders;
     QFile m_file;
@@ -177,9 +289,13 @@ private:
 
     QMap <QString, QVariant> m_exposeOptions;
     QList <QString> m_specialExposes;
+    QMap <QString, QList <QString>> m_groups;
 
     void unserialize(const QJsonArray &devices);
+    void unserializeGroups(const QJsonObject &groups);
+
     QJsonArray serialize(void);
+    QJsonObject serializeGroups(void);
 
 private slots:
 
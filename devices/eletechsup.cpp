@@ -212,7 +212,7 @@ void Eletechsup::R4Pin08::enqueueAction(quint8 endpointId, const QString &name,
             default: return;
         }
 
-        m_actionQueue.enqueue(m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleCoil, endpointId - 1, value ? 0xFF00 : 0x0000));
+        enqueueCoil(endpointId - 1, value);
     }
 }
 
@@ -286,7 +286,7 @@ void Eletechsup::R4Pin08::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert(m_sequence ? "outputMode" : "inputMode", value ? "high" : "low");
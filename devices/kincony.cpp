@@ -118,7 +118,7 @@ void Kincony::KC868::enqueueAction(quint8 endpointId, const QString &name, const
             default: return;
         }
 
-        m_actionQueue.enqueue(m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleCoil, endpointId - 1, value ? 0xFF00 : 0x0000));
+        enqueueCoil(endpointId - 1, value);
     }
     else if (name == "analogOutput" && endpointId && endpointId <= m_channels)
         m_actionQueue.enqueue(m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleRegister, endpointId - 1, static_cast <quint16> (data.toInt() & 0xFF)));
@@ -222,7 +222,7 @@ void Kincony::KC868::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(1)->buffer().insert("analogOutput", value >> 8);
@@ -58,7 +58,8 @@ void Native::Common::actionFinished(void)
     if (!check)
         return;
 
-    emit deviceUpdated(this);
+    resetCapture();
+    emit deviceUpdated(sharedFromThis());
 }
 
 void Native::Common::startPoll(void)
@@ -93,7 +94,7 @@ void Native::Common::parseReply(const QByteArray &reply)
     {
         case 0:
         {
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("slaveId", value);
@@ -102,7 +103,7 @@ void Native::Common::parseReply(const QByteArray &reply)
 
         case 1:
         {
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("baudRate", value * 100);
@@ -195,7 +196,7 @@ void Native::RelayController::parseReply(const QByteArray &reply)
     {
         case 0:
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("invert", value ? true : false);
@@ -203,7 +204,7 @@ void Native::RelayController::parseReply(const QByteArray &reply)
 
         case 1:
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             for (quint8 i = 0; i < 16; i++)
@@ -247,13 +248,6 @@ void Native::SwitchController::init(const Device &device, const QMap <QString, Q
 
     m_options.insert("invert", QMap <QString, QVariant> {{"type", "toggle"}, {"icon", "mdi:swap-horizontal-bold"}});
     m_options.insert("action", QMap <QString, QVariant> {{"type", "sensor"}, {"enum", QList <QVariant> {"singleClick", "doubleClick", "hold", "release"}}, {"icon", "mdi:gesture-double-tap"}});
-
-    memset(m_time, 0, sizeof(m_time));
-    memset(m_count, 0, sizeof(m_count));
-    memset(m_hold, 0, sizeof(m_hold));
-
-    connect(m_timer, &QTimer::timeout, this, &SwitchController::update);
-    m_timer->start(1);
 }
 
 void Native::SwitchController::enqueueAction(quint8, const QString &name, const QVariant &data)
@@ -297,7 +291,7 @@ void Native::SwitchController::parseReply(const QByteArray &reply)
     {
         case 0:
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("invert", value ? true : false);
@@ -305,7 +299,7 @@ void Native::SwitchController::parseReply(const QByteArray &reply)
 
         case 1:
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             if (m_fullPoll)
@@ -318,15 +312,10 @@ void Native::SwitchController::parseReply(const QByteArray &reply)
             {
                 quint16 status = value & 1 << i;
 
-                if ((m_status & 1 << i) == status)
-                    continue;
-
-                m_time[i] = QDateTime::currentMSecsSinceEpoch();
-
-                if (status)
+                if ((m_status & 1 << i) == status || !m_gestures)
                     continue;
 
-                m_count[i]++;
+                m_gestures->update(this, i + 1, status ? true : false);
             }
 
             m_status = value;
@@ -335,35 +324,3 @@ void Native::SwitchController::parseReply(const QByteArray &reply)
 
     m_sequence++;
 }
-
-void Native::SwitchController::update(void)
-{
-    for (quint8 i = 0; i < 16; i++)
-    {
-        auto it = m_endpoints.find(i + 1);
-
-        if (!m_time[i] || m_time[i] + 200 > QDateTime::currentMSecsSinceEpoch())
-            continue;
-
-        if (!(m_status & 1 << i))
-        {
-            it.value()->buffer().insert("action", m_count[i] < 2 ? m_hold[i] ? "release" : "singleClick" : "doubleClick");
-            m_hold[i] = false;
-        }
-        else if (m_time[i] + 1000 <= QDateTime::currentMSecsSinceEpoch())
-        {
-            it.value()->buffer().insert("action", "hold");
-            m_hold[i] = true;
-        }
-        else
-            continue;
-
-        m_count[i] = 0;
-        m_time[i] = 0;
-
-        updateEndpoints();
-
-        it.value()->status().clear();
-        it.value()->buffer().clear();
-    }
-}
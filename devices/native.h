@@ -52,12 +52,11 @@ namespace Native
 
     class SwitchController : public DeviceObject
     {
-        Q_OBJECT
 
     public:
 
         SwitchController(quint8 portId, quint8 slaveId, quint32 baudRate, quint32 pollInterval, quint32 requestTimeout, quint32 replyTimeout, const QString &name) :
-            DeviceObject(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), m_timer(new QTimer(this)) {}
+            DeviceObject(portId, slaveId, baudRate, pollInterval, requestTimeout, replyTimeout, name), m_status(0) {}
 
         void init(const Device &device, const QMap <QString, QVariant> &exposeOptions) override;
         void enqueueAction(quint8 endpointId, const QString &name, const QVariant &data) override;
@@ -68,15 +67,7 @@ namespace Native
 
     private:
 
-        QTimer *m_timer;
         quint16 m_status;
-        qint64 m_time[16];
-        quint8 m_count[16];
-        bool m_hold[16];
-
-    private slots:
-
-        void update(void);
 
     };
 }
@@ -192,7 +192,7 @@ void Neptun::SmartPlus::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok || m_status == value)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok || m_status == value)
                 break;
 
             m_endpoints.value(0)->buffer().insert("enableGroups",   value & 0x0400 ? true : false);
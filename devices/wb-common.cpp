@@ -62,7 +62,8 @@ void WirenBoard::Common::actionFinished(void)
     if (!check)
         return;
 
-    emit deviceUpdated(this);
+    resetCapture();
+    emit deviceUpdated(sharedFromThis());
 }
 
 void WirenBoard::Common::startPoll(void)
@@ -98,7 +99,7 @@ void WirenBoard::Common::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("slaveId", value);
@@ -109,7 +110,7 @@ void WirenBoard::Common::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("baudRate", value * 100);
@@ -199,6 +200,8 @@ void WirenBoard::WBUps::init(const Device &device, const QMap <QString, QVariant
     m_options.insert("operationMode",      QMap <QString, QVariant> {{"type", "select"}, {"enum", QList <QVariant> {"auto", "manual"}}, {"icon", "mdi:cog"}});
     m_options.insert("outputVoltageLimit", QMap <QString, QVariant> {{"type", "number"}, {"min", 9}, {"max", 25.6}, {"step", 0.1}, {"unit", "V"}, {"icon", "mdi:sine-wave"}});
     m_options.insert("chargeCurrentLimit", QMap <QString, QVariant> {{"type", "number"}, {"min", 0.3}, {"max", 2}, {"step", 0.1}, {"unit", "A"}, {"icon", "mdi:current-ac"}});
+
+    m_counters.setup({{DEFAULT_ENDPOINT, "action"}});
 }
 
 void WirenBoard::WBUps::enqueueAction(quint8, const QString &name, const QVariant &data)
@@ -248,7 +251,6 @@ QByteArray WirenBoard::WBUps::pollRequest(void)
     }
 
     updateEndpoints();
-    m_endpoints.value(0)->buffer().remove("action");
 
     m_pollTime = QDateTime::currentMSecsSinceEpoch();
     m_polling = false;
@@ -312,34 +314,12 @@ void WirenBoard::WBUps::parseReply(const QByteArray &reply)
 
         case 2 ... 4:
         {
-            quint16 value, *counter;
-            QString action;
-
-            switch (m_sequence)
-            {
-                case 2:
-                    counter = &m_singleClick;
-                    action = "singleClick";
-                    break;
-
-                case 3:
-                    counter = &m_hold;
-                    action = "hold";
-                    break;
-
-                case 4:
-                    counter = &m_doubleClick;
-                    action = "doubleClick";
-                    break;
-            }
+            quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok || *counter == value)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
-            if (!m_fullPoll)
-                m_endpoints.value(0)->buffer().insert("action", action);
-
-            *counter = value;
+            parseCounters(m_sequence - 2, &value);
             break;
         }
     }
@@ -349,6 +329,8 @@ void WirenBoard::WBUps::parseReply(const QByteArray &reply)
 
 void WirenBoard::WBMwac::init(const Device &device, const QMap <QString, QVariant> &exposeOptions)
 {
+    QList <CounterDecoder::Input> inputs;
+
     m_type = "wbMwac";
     m_description = "Wiren Board WB-MWAC v2 Water Leak Detector";
     m_modes = {"disabled", "edge", "sensor", "input"};
@@ -433,6 +415,11 @@ void WirenBoard::WBMwac::init(const Device &device, const QMap <QString, QVarian
     m_options.insert("cleaningMode",  QMap <QString, QVariant> {{"type", "toggle"}, {"control", true}, {"icon", "mdi:vacuum"}});
 
     m_options.insert("lock",          "valve");
+
+    for (quint8 i = 0; i < 6; i++)
+        inputs.append({static_cast <quint8> (i + 11), "action"});
+
+    m_counters.setup(inputs);
 }
 
 void WirenBoard::WBMwac::enqueueAction(quint8 endpointId, const QString &name, const QVariant &data)
@@ -548,9 +535,6 @@ QByteArray WirenBoard::WBMwac::pollRequest(void)
 
     updateEndpoints();
 
-    for (quint8 i = 0; i < 6; i++)
-        m_endpoints.value(i + 11)->buffer().remove("action");
-
     m_pollTime = QDateTime::currentMSecsSinceEpoch();
     m_polling = false;
     m_fullPoll = false;
@@ -628,41 +612,12 @@ void WirenBoard::WBMwac::parseReply(const QByteArray &reply)
 
         case 4 ... 6:
         {
-            quint16 data[6], *counter;
-            QString action;
-
-            switch (m_sequence)
-            {
-                case 4:
-                    counter = m_singleClick;
-                    action = "singleClick";
-                    break;
-
-                case 5:
-                    counter = m_hold;
-                    action = "hold";
-                    break;
-
-                case 6:
-                    counter = m_doubleClick;
-                    action = "doubleClick";
-                    break;
-            }
+            quint16 data[6];
 
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
-            for (quint8 i = 0; i < 6; i++)
-            {
-                if (counter[i] == data[i])
-                    continue;
-
-                if (!m_fullPoll)
-                    m_endpoints.value(i + 11)->buffer().insert("action", action);
-
-                counter[i] = data[i];
-            }
-
+            parseCounters(m_sequence - 4, data);
             break;
         }
 
@@ -670,7 +625,7 @@ void WirenBoard::WBMwac::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             switch (value)
@@ -43,10 +43,6 @@ namespace WirenBoard
         QByteArray pollRequest(void) override;
         void parseReply(const QByteArray &reply) override;
 
-    private:
-
-        quint16 m_singleClick, m_hold, m_doubleClick;
-
     };
 
     class WBMwac : public DeviceObject
@@ -66,7 +62,7 @@ namespace WirenBoard
 
     private:
 
-        quint16 m_output[2], m_singleClick[6], m_hold[6], m_doubleClick[6];
+        quint16 m_output[2];
         QList <QVariant> m_modes;
 
     };
@@ -5,6 +5,8 @@
 
 void WirenBoard::WBMdm::init(const Device &device, const QMap <QString, QVariant> &)
 {
+    QList <CounterDecoder::Input> inputs;
+
     m_type = "wbMdm";
     m_description = "Wiren Board WB-MDM3 Mosfet Dimmer";
     m_modes = {"log", "linear", "switch"};
@@ -53,6 +55,10 @@ void WirenBoard::WBMdm::init(const Device &device, const QMap <QString, QVariant
     m_options.insert("input",        QMap <QString, QVariant> {{"type", "sensor"}, {"icon", "mdi:import"}});
     m_options.insert("action",       QMap <QString, QVariant> {{"type", "sensor"}, {"enum", QList <QVariant> {"singleClick", "doubleClick", "hold"}}, {"icon", "mdi:gesture-double-tap"}});
 
+    for (quint8 i = 0; i < 6; i++)
+        inputs.append({static_cast <quint8> (i + 11), "action"});
+
+    m_counters.setup(inputs);
 }
 
 void WirenBoard::WBMdm::enqueueAction(quint8 endpointId, const QString &name, const QVariant &data)
@@ -83,7 +89,8 @@ void WirenBoard::WBMdm::enqueueAction(quint8 endpointId, const QString &name, co
 
         case 1: // level
         {
-            m_actionQueue.enqueue(m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleRegister, endpointId - 1, static_cast <quint16> (round(data.toInt() / 2.55))));
+            quint16 value = static_cast <quint16> (round(data.toInt() / 2.55));
+            m_actionQueue.enqueue(m_readWrite ? m_modbus->makeRequest(m_slaveId, Modbus::ReadWriteMultipleRegisters, 0x0000, 3, &value, endpointId - 1, 1) : m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleRegister, endpointId - 1, value));
             return;
         }
 
@@ -111,6 +118,38 @@ void WirenBoard::WBMdm::enqueueAction(quint8 endpointId, const QString &name, co
     m_fullPoll = true;
 }
 
+bool WirenBoard::WBMdm::parseAction(const QByteArray &reply)
+{
+    quint16 data[3];
+
+    if (!m_readWrite || m_modbus->parseReply(m_slaveId, Modbus::ReadWriteMultipleRegisters, reply, data) != Modbus::ReplyStatus::Ok)
+        return false;
+
+    for (quint8 i = 0; i < 3; i++)
+        m_endpoints.value(i + 1)->buffer().insert("level", round(data[i] * 2.55));
+
+    updateEndpoints();
+    return true;
+}
+
+QByteArray WirenBoard::WBMdm::subscriptionRequest(void)
+{
+    QByteArray payload;
+
+    for (quint8 i = 0; i < 3; i++)
+        payload.append(Modbus::eventBlock(Modbus::InputEvent, 0x01D0 + i * 0x10, 6));
+
+    return Modbus::fastRequest(m_slaveId, Modbus::EventControl, payload);
+}
+
+void WirenBoard::WBMdm::parseEvent(quint8 type, quint16 address, const QByteArray &data)
+{
+    if (type != Modbus::InputEvent || address < 0x01D0)
+        return;
+
+    parseCounterEvent(address - 0x01D0, data);
+}
+
 void WirenBoard::WBMdm::startPoll(void)
 {
     if (m_polling)
@@ -140,14 +179,15 @@ QByteArray WirenBoard::WBMdm::pollRequest(void)
             return m_modbus->makeRequest(m_slaveId, Modbus::ReadHoldingRegisters, 0x0000, 3);
 
         case 5 ... 7:
+
+            if (m_events && !m_fullPoll)
+                break;
+
             return m_modbus->makeRequest(m_slaveId, Modbus::ReadInputRegisters, 0x01D0 + (m_sequence - 5) * 0x10, 6);
     }
 
     updateEndpoints();
 
-    for (quint8 i = 0; i < 6; i++)
-        m_endpoints.value(i + 11)->buffer().remove("action");
-
     m_pollTime = QDateTime::currentMSecsSinceEpoch();
     m_polling = false;
     m_fullPoll = false;
@@ -228,41 +268,12 @@ void WirenBoard::WBMdm::parseReply(const QByteArray &reply)
 
         case 5 ... 7:
         {
-            quint16 data[6], *counter;
-            QString action;
-
-            switch (m_sequence)
-            {
-                case 5:
-                    counter = m_singleClick;
-                    action = "singleClick";
-                    break;
-
-                case 6:
-                    counter = m_hold;
-                    action = "hold";
-                    break;
-
-                case 7:
-                    counter = m_doubleClick;
-                    action = "doubleClick";
-                    break;
-            }
+            quint16 data[6];
 
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
-            for (quint8 i = 0; i < 6; i++)
-            {
-                if (counter[i] == data[i])
-                    continue;
-
-                if (!m_fullPoll)
-                    m_endpoints.value(i + 11)->buffer().insert("action", action);
-
-                counter[i] = data[i];
-            }
-
+            parseCounters(m_sequence - 5, data);
             break;
         }
     }
@@ -272,6 +283,8 @@ void WirenBoard::WBMdm::parseReply(const QByteArray &reply)
 
 void WirenBoard::WBLed::init(const Device &device, const QMap <QString, QVariant> &)
 {
+    QList <CounterDecoder::Input> inputs;
+
     switch (m_model)
     {
         case Model::wbLed0:
@@ -399,6 +412,11 @@ void WirenBoard::WBLed::init(const Device &device, const QMap <QString, QVariant
     m_options.insert("input",            QMap <QString, QVariant> {{"type", "sensor"}, {"icon", "mdi:import"}});
     m_options.insert("action",           QMap <QString, QVariant> {{"type", "sensor"}, {"enum", QList <QVariant> {"singleClick", "doubleClick", "hold"}}, {"icon", "mdi:gesture-double-tap"}});
     m_options.insert("frequencyDivider", QMap <QString, QVariant> {{"type", "number"}, {"min", 1}, {"max", 240}, {"icon", "mdi:square-wave"}});
+
+    for (quint8 i = 0; i < 4; i++)
+        inputs.append({static_cast <quint8> (i + 11), "action"});
+
+    m_counters.setup(inputs);
 }
 
 void WirenBoard::WBLed::enqueueAction(quint8 endpointId, const QString &name, const QVariant &data)
@@ -436,7 +454,8 @@ void WirenBoard::WBLed::enqueueAction(quint8 endpointId, const QString &name, co
 
         case 1: // level
         {
-            m_actionQueue.enqueue(m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleRegister, 0x07D0 + (endpointId <= 9 ? endpointId <= 7 ? endpointId - 1 : (endpointId - 8) * 2 + 8 : 16), static_cast <quint16> (round(data.toInt() / 2.55))));
+            quint16 address = 0x07D0 + (endpointId <= 9 ? endpointId <= 7 ? endpointId - 1 : (endpointId - 8) * 2 + 8 : 16), value = static_cast <quint16> (round(data.toInt() / 2.55));
+            m_actionQueue.enqueue(m_readWrite ? m_modbus->makeRequest(m_slaveId, Modbus::ReadWriteMultipleRegisters, 0x07D0, 17, &value, address, 1) : m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleRegister, address, value));
             break;
         }
 
@@ -466,6 +485,36 @@ void WirenBoard::WBLed::enqueueAction(quint8 endpointId, const QString &name, co
     }
 }
 
+bool WirenBoard::WBLed::parseAction(const QByteArray &reply)
+{
+    quint16 data[17];
+
+    if (!m_readWrite || m_modbus->parseReply(m_slaveId, Modbus::ReadWriteMultipleRegisters, reply, data) != Modbus::ReplyStatus::Ok)
+        return false;
+
+    parseLevels(data);
+    updateEndpoints();
+    return true;
+}
+
+QByteArray WirenBoard::WBLed::subscriptionRequest(void)
+{
+    QByteArray payload;
+
+    for (quint8 i = 0; i < 3; i++)
+        payload.append(Modbus::eventBlock(Modbus::InputEvent, 0x01D0 + i * 0x10, 4));
+
+    return Modbus::fastRequest(m_slaveId, Modbus::EventControl, payload);
+}
+
+void WirenBoard::WBLed::parseEvent(quint8 type, quint16 address, const QByteArray &data)
+{
+    if (type != Modbus::InputEvent || address < 0x01D0)
+        return;
+
+    parseCounterEvent(address - 0x01D0, data);
+}
+
 void WirenBoard::WBLed::startPoll(void)
 {
     if (m_polling)
@@ -495,14 +544,15 @@ QByteArray WirenBoard::WBLed::pollRequest(void)
             return m_modbus->makeRequest(m_slaveId, Modbus::ReadHoldingRegisters, 0x07D0, 17);
 
         case 5 ... 7:
+
+            if (m_events && !m_fullPoll)
+                break;
+
             return m_modbus->makeRequest(m_slaveId, Modbus::ReadInputRegisters, 0x01D0 + (m_sequence - 5) * 0x10, 4);
     }
 
     updateEndpoints();
 
-    for (quint8 i = 0; i < 4; i++)
-        m_endpoints.value(i + 11)->buffer().remove("action");
-
     m_pollTime = QDateTime::currentMSecsSinceEpoch();
     m_polling = false;
     m_fullPoll = false;
@@ -526,7 +576,7 @@ void WirenBoard::WBLed::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("frequencyDivider", value);
@@ -572,81 +622,56 @@ void WirenBoard::WBLed::parseReply(const QByteArray &reply)
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
-            for (quint8 i = 0; i < 10; i++)
-            {
-                auto it = m_endpoints.find(i + 1);
+            parseLevels(data);
+            break;
+        }
 
-                if (!m_list.contains(i + 1))
-                    continue;
+        case 5 ... 7:
+        {
+            quint16 data[4];
 
-                switch (i)
-                {
-                    case 0 ... 6:
-                    {
-                        it.value()->buffer().insert("level", round(data[i] * 2.55));
-                        break;
-                    }
-
-                    case 7 ... 8:
-                    {
-                        it.value()->buffer().insert("level", round(data[(i - 7) * 2 + 8] * 2.55));
-                        it.value()->buffer().insert("colorTemperature", 450 - data[7 + (i - 7) * 2] * 3);
-                        break;
-                    }
-
-                    case 9:
-                    {
-                        Color color(Color::fromHS(data[14] / 360.0, data[15] / 100.0));
-                        it.value()->buffer().insert("level", data[16] * 2.55);
-                        it.value()->buffer().insert("color", QList <QVariant> {static_cast <quint8> (color.r() * 255), static_cast <quint8> (color.g() * 255), static_cast <quint8> (color.b() * 255)});
-                        break;
-                    }
-                }
-            }
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
+                break;
 
+            parseCounters(m_sequence - 5, data);
             break;
         }
+    }
 
-        case 5 ... 7:
-        {
-            quint16 data[4], *counter;
-            QString action;
+    m_sequence++;
+}
 
-            switch (m_sequence)
+void WirenBoard::WBLed::parseLevels(const quint16 *data)
+{
+    for (quint8 i = 0; i < 10; i++)
+    {
+        auto it = m_endpoints.find(i + 1);
+
+        if (!m_list.contains(i + 1))
+            continue;
+
+        switch (i)
+        {
+            case 0 ... 6:
             {
-                case 5:
-                    counter = m_singleClick;
-                    action = "singleClick";
-                    break;
-
-                case 6:
-                    counter = m_hold;
-                    action = "hold";
-                    break;
-
-                case 7:
-                    counter = m_doubleClick;
-                    action = "doubleClick";
-                    break;
+                it.value()->buffer().insert("level", round(data[i] * 2.55));
+                break;
             }
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
+            case 7 ... 8:
+            {
+                it.value()->buffer().insert("level", round(data[(i - 7) * 2 + 8] * 2.55));
+                it.value()->buffer().insert("colorTemperature", 450 - data[7 + (i - 7) * 2] * 3);
                 break;
+            }
 
-            for (quint8 i = 0; i < 4; i++)
+            case 9:
             {
-                if (counter[i] == data[i])
-                    continue;
-
-                if (!m_fullPoll)
-                    m_endpoints.value(i + 11)->buffer().insert("action", action);
-
-                counter[i] = data[i];
+                Color color(Color::fromHS(data[14] / 360.0, data[15] / 100.0));
+                it.value()->buffer().insert("level", data[16] * 2.55);
+                it.value()->buffer().insert("color", QList <QVariant> {static_cast <quint8> (color.r() * 255), static_cast <quint8> (color.g() * 255), static_cast <quint8> (color.b() * 255)});
+                break;
             }
-
-            break;
         }
     }
-
-    m_sequence++;
 }
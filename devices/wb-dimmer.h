@@ -15,14 +15,18 @@ namespace WirenBoard
 
         void init(const Device &device, const QMap <QString, QVariant> &exposeOptions) override;
         void enqueueAction(quint8 endpointId, const QString &name, const QVariant &data) override;
+        bool parseAction(const QByteArray &reply) override;
         void startPoll(void) override;
 
         QByteArray pollRequest(void) override;
         void parseReply(const QByteArray &reply) override;
 
+        QByteArray subscriptionRequest(void) override;
+        void parseEvent(quint8 type, quint16 address, const QByteArray &data) override;
+
     private:
 
-        quint16 m_output[3], m_singleClick[6], m_hold[6], m_doubleClick[6];
+        quint16 m_output[3];
         QList <QVariant> m_modes;
 
     };
@@ -39,17 +43,23 @@ namespace WirenBoard
 
         void init(const Device &device, const QMap <QString, QVariant> &exposeOptions) override;
         void enqueueAction(quint8 endpointId, const QString &name, const QVariant &data) override;
+        bool parseAction(const QByteArray &reply) override;
         void startPoll(void) override;
 
         QByteArray pollRequest(void) override;
         void parseReply(const QByteArray &reply) override;
 
+        QByteArray subscriptionRequest(void) override;
+        void parseEvent(quint8 type, quint16 address, const QByteArray &data) override;
+
     private:
 
         Model m_model;
-        quint16 m_mode, m_output[10], m_singleClick[4], m_hold[4], m_doubleClick[4];
+        quint16 m_mode, m_output[10];
         QList <quint8> m_list;
 
+        void parseLevels(const quint16 *data);
+
     };
 
     class WBLed0 : public WBLed
@@ -33,6 +33,8 @@ void WirenBoard::WBMap3ev::init(const Device &device, const QMap <QString, QVari
     }
 
     updateOptions(exposeOptions);
+
+    m_stepIntervals = {{0, WBMAP_SLOW_INTERVAL}, {2, WBMAP_SLOW_INTERVAL}};
 }
 
 void WirenBoard::WBMap3ev::startPoll(void)
@@ -42,10 +44,14 @@ void WirenBoard::WBMap3ev::startPoll(void)
 
     m_sequence = 0;
     m_polling = true;
+
+    startSteps();
 }
 
 QByteArray WirenBoard::WBMap3ev::pollRequest(void)
 {
+    skipSteps(3);
+
     switch (m_sequence)
     {
         case 0: return m_modbus->makeRequest(m_slaveId, Modbus::ReadInputRegisters, WBMAP_FREQUENCY_REGISTER_ADDRESS, 1);
@@ -68,7 +74,7 @@ void WirenBoard::WBMap3ev::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("frequency", static_cast <double> (value) * WBMAP_FREQUENCY_MULTIPLIER / 1000);
@@ -171,6 +177,8 @@ void WirenBoard::WBMap3e::init(const Device &device, const QMap <QString, QVaria
     m_options.insert("angle",       QMap <QString, QVariant> {{"type", "sensor"}, {"unit", "°"}, {"icon", "mdi:angle-acute"}});
     m_options.insert("delta",       QMap <QString, QVariant> {{"type", "number"}, {"min", -32768}, {"max", 32767}, {"icon", "mdi:delta"}});
     m_options.insert("ratio",       QMap <QString, QVariant> {{"type", "number"}, {"min", 0}, {"max", 65535}, {"icon", "mdi:alpha-k-box-outline"}});
+
+    m_stepIntervals = {{1, WBMAP_SLOW_INTERVAL}, {5, WBMAP_ENERGY_INTERVAL}, {6, WBMAP_SLOW_INTERVAL}};
 }
 
 void WirenBoard::WBMap3e::enqueueAction(quint8 endpointId, const QString &name, const QVariant &data)
@@ -198,10 +206,14 @@ void WirenBoard::WBMap3e::startPoll(void)
 
     m_sequence = m_fullPoll ? 0 : 1;
     m_polling = true;
+
+    startSteps();
 }
 
 QByteArray WirenBoard::WBMap3e::pollRequest(void)
 {
+    skipSteps(7);
+
     switch (m_sequence)
     {
         case 0: return m_modbus->makeRequest(m_slaveId, Modbus::ReadHoldingRegisters, WBMAP_COIL_REGISTER_ADDRESS, WBMAP_COIL_REGISTER_COUNT);
@@ -246,7 +258,7 @@ void WirenBoard::WBMap3e::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("frequency", static_cast <double> (value) * WBMAP_FREQUENCY_MULTIPLIER / 1000);
@@ -412,9 +424,6 @@ void WirenBoard::WBMap6s::startPoll(void)
 
     m_sequence = m_fullPoll ? 0 : 2;
     m_polling = true;
-
-    m_totalPower = 0;
-    m_totalEnergy = 0;
 }
 
 QByteArray WirenBoard::WBMap6s::pollRequest(void)
@@ -476,7 +485,7 @@ void WirenBoard::WBMap6s::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("voltage", static_cast <double> (value) * WBMAP6S_VOLTAGE_MULTIPLIER / 1000);
@@ -487,7 +496,7 @@ void WirenBoard::WBMap6s::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("frequency", static_cast <double> (value) * WBMAP_FREQUENCY_MULTIPLIER / 1000);
@@ -511,6 +520,9 @@ void WirenBoard::WBMap6s::parseReply(const QByteArray &reply)
         {
             quint16 data[WBMAP_POWER_REGISTER_COUNT];
 
+            if (m_sequence == 6)
+                m_totalPower = 0;
+
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
@@ -528,6 +540,9 @@ void WirenBoard::WBMap6s::parseReply(const QByteArray &reply)
         {
             quint16 data[WBMAP_ENERGY_REGISTER_COUNT];
 
+            if (m_sequence == 8)
+                m_totalEnergy = 0;
+
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
@@ -717,7 +732,7 @@ void WirenBoard::WBMap12::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("frequency", static_cast <double> (value) * WBMAP_FREQUENCY_MULTIPLIER / 1000);
@@ -40,6 +40,9 @@
 #define WBMAP_ANGLE_REGISTER_COUNT          3
 #define WBMAP_ANGLE_MULTIPLIER              100.0
 
+#define WBMAP_SLOW_INTERVAL                 10000
+#define WBMAP_ENERGY_INTERVAL               60000
+
 #include "device.h"
 
 namespace WirenBoard
@@ -3,6 +3,8 @@
 
 void WirenBoard::WBMr::init(const Device &device, const QMap <QString, QVariant> &exposeOptions)
 {
+    QList <CounterDecoder::Input> inputs;
+
     switch (m_model)
     {
         case Model::wbMrwm2:
@@ -120,6 +122,16 @@ void WirenBoard::WBMr::init(const Device &device, const QMap <QString, QVariant>
     m_options.insert("voltageProtection", QMap <QString, QVariant> {{"type", "toggle"}, {"icon", "mdi:sine-wave"}});
     m_options.insert("voltageLow",        QMap <QString, QVariant> {{"type", "number"}, {"min", 120}, {"max", 220}, {"unit", "V"}, {"icon", "mdi:sine-wave"}});
     m_options.insert("voltageHigh",       QMap <QString, QVariant> {{"type", "number"}, {"min", 230}, {"max", 277}, {"unit", "V"}, {"icon", "mdi:sine-wave"}});
+
+    for (quint8 i = 0; i < m_inputs; i++)
+    {
+        if (i < m_channels)
+            inputs.append({static_cast <quint8> (i + 1), "action"});
+        else
+            inputs.append({DEFAULT_ENDPOINT, m_inputs == 8 && i == 7 ? "action_0" : QString()});
+    }
+
+    m_counters.setup(inputs);
 }
 
 void WirenBoard::WBMr::enqueueAction(quint8 endpointId, const QString &name, const QVariant &data)
@@ -143,7 +155,7 @@ void WirenBoard::WBMr::enqueueAction(quint8 endpointId, const QString &name, con
             default: return;
         }
 
-        m_actionQueue.enqueue(m_modbus->makeRequest(m_slaveId, Modbus::WriteSingleCoil, endpointId - 1, value ? 0xFF00 : 0x0000));
+        enqueueCoil(endpointId - 1, value);
         return;
     }
 
@@ -168,6 +180,27 @@ void WirenBoard::WBMr::enqueueAction(quint8 endpointId, const QString &name, con
     m_fullPoll = true;
 }
 
+QByteArray WirenBoard::WBMr::subscriptionRequest(void)
+{
+    QByteArray payload;
+
+    if (!m_inputs)
+        return payload;
+
+    for (quint8 i = 0; i < 3; i++)
+        payload.append(Modbus::eventBlock(Modbus::InputEvent, 0x01D0 + i * 0x10, m_inputs));
+
+    return Modbus::fastRequest(m_slaveId, Modbus::EventControl, payload);
+}
+
+void WirenBoard::WBMr::parseEvent(quint8 type, quint16 address, const QByteArray &data)
+{
+    if (type != Modbus::InputEvent || address < 0x01D0)
+        return;
+
+    parseCounterEvent(address - 0x01D0, data);
+}
+
 void WirenBoard::WBMr::startPoll(void)
 {
     if (m_polling)
@@ -199,6 +232,12 @@ QByteArray WirenBoard::WBMr::pollRequest(void)
             if (!m_inputs)
                 break;
 
+            if (m_events && !m_fullPoll)
+            {
+                m_sequence = 8;
+                return pollRequest();
+            }
+
             return m_modbus->makeRequest(m_slaveId, Modbus::ReadInputRegisters, 0x01D0 + (m_sequence - 5) * 0x10, m_inputs);
 
         case 8:
@@ -225,9 +264,6 @@ QByteArray WirenBoard::WBMr::pollRequest(void)
 
     updateEndpoints();
 
-    for (quint8 i = m_inputs == 8 ? 0 : 1; i <= m_channels; i++)
-        m_endpoints.value(i)->buffer().remove(i ? "action" : "action_0");
-
     m_pollTime = QDateTime::currentMSecsSinceEpoch();
     m_polling = false;
     m_fullPoll = false;
@@ -289,49 +325,12 @@ void WirenBoard::WBMr::parseReply(const QByteArray &reply)
 
         case 5 ... 7:
         {
-            quint16 data[8], *counter;
-            QString action;
-
-            switch (m_sequence)
-            {
-                case 5:
-                    counter = m_singleClick;
-                    action = "singleClick";
-                    break;
-
-                case 6:
-                    counter = m_hold;
-                    action = "hold";
-                    break;
-
-                case 7:
-                    counter = m_doubleClick;
-                    action = "doubleClick";
-                    break;
-            }
+            quint16 data[8];
 
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
-            for (quint8 i = 0; i < m_channels; i++)
-            {
-                if (counter[i] == data[i])
-                    continue;
-
-                if (!m_fullPoll)
-                    m_endpoints.value(i + 1)->buffer().insert("action", action);
-
-                counter[i] = data[i];
-            }
-
-            if (m_inputs == 8 && counter[7] != data[7])
-            {
-                if (!m_fullPoll)
-                    m_endpoints.value(0)->buffer().insert("action_0", action);
-
-                counter[7] = data[7];
-            }
-
+            parseCounters(m_sequence - 5, data);
             break;
         }
 
@@ -22,11 +22,14 @@ namespace WirenBoard
         QByteArray pollRequest(void) override;
         void parseReply(const QByteArray &reply) override;
 
+        QByteArray subscriptionRequest(void) override;
+        void parseEvent(quint8 type, quint16 address, const QByteArray &data) override;
+
     private:
 
         Model m_model;
         quint8 m_channels, m_inputs;
-        quint16 m_output[6], m_singleClick[8], m_hold[8], m_doubleClick[8];
+        quint16 m_output[6];
 
     };
 
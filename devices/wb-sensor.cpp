@@ -4,6 +4,8 @@
 
 void WirenBoard::WBM1w2::init(const Device &device, const QMap <QString, QVariant> &exposeOptions)
 {
+    QList <CounterDecoder::Input> inputs;
+
     m_type = "wbM1w2";
     m_description = "Wiren Board WB-M1W2 Temperature Sensor";
 
@@ -40,6 +42,11 @@ void WirenBoard::WBM1w2::init(const Device &device, const QMap <QString, QVarian
     m_options.insert("input",         QMap <QString, QVariant> {{"type", "sensor"}, {"icon", "mdi:import"}});
     m_options.insert("action",        QMap <QString, QVariant> {{"type", "sensor"}, {"enum", QList <QVariant> {"singleClick", "doubleClick", "hold"}}, {"icon", "mdi:gesture-double-tap"}});
     m_options.insert("operationMode", QMap <QString, QVariant> {{"type", "select"}, {"enum", QList <QVariant> {"temperature", "input"}}, {"icon", "mdi:cog"}});
+
+    for (quint8 i = 0; i < 2; i++)
+        inputs.append({static_cast <quint8> (i + 1), "action"});
+
+    m_counters.setup(inputs);
 }
 
 void WirenBoard::WBM1w2::enqueueAction(quint8 endpointId, const QString &name, const QVariant &data)
@@ -79,9 +86,6 @@ QByteArray WirenBoard::WBM1w2::pollRequest(void)
 
     updateEndpoints();
 
-    for (quint8 i = 0; i < 2; i++)
-        m_endpoints.value(i + 1)->buffer().remove("action");
-
     m_pollTime = QDateTime::currentMSecsSinceEpoch();
     m_polling = false;
     m_fullPoll = false;
@@ -137,41 +141,10 @@ void WirenBoard::WBM1w2::parseReply(const QByteArray &reply)
 
         case 3 ... 5:
         {
-            quint16 *counter;
-            QString action;
-
-            switch (m_sequence)
-            {
-                case 3:
-                    counter = m_singleClick;
-                    action = "singleClick";
-                    break;
-
-                case 4:
-                    counter = m_hold;
-                    action = "hold";
-                    break;
-
-                case 5:
-                    counter = m_doubleClick;
-                    action = "doubleClick";
-                    break;
-            }
-
             if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, data) != Modbus::ReplyStatus::Ok)
                 break;
 
-            for (quint8 i = 0; i < 2; i++)
-            {
-                if (counter[i] == data[i])
-                    continue;
-
-                if (!m_fullPoll)
-                    m_endpoints.value(i + 1)->buffer().insert("action", action);
-
-                counter[i] = data[i];
-            }
-
+            parseCounters(m_sequence - 3, data);
             break;
         }
     }
@@ -302,7 +275,7 @@ void WirenBoard::WBMs::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("illuminance", value);
@@ -341,7 +314,7 @@ void WirenBoard::WBMs::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             if (value != 0xFFFF)
@@ -505,7 +478,7 @@ void WirenBoard::WBMsw::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadHoldingRegisters, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(0)->buffer().insert("co2AutoCalibration", value ? true : false);
@@ -528,7 +501,7 @@ void WirenBoard::WBMsw::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadCoilStatus, reply, &value) != Modbus::ReplyStatus::Ok)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadCoilStatus, reply, value) != Modbus::ReplyStatus::Ok)
                 break;
 
             m_endpoints.value(1)->buffer().insert("status", value ? "on" : "off");
@@ -602,7 +575,7 @@ void WirenBoard::WBMsw::parseReply(const QByteArray &reply)
         {
             quint16 value;
 
-            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, &value) != Modbus::ReplyStatus::Ok || value < WBMSW_OCCUPANCY_THRESHOLD)
+            if (m_modbus->parseReply(m_slaveId, Modbus::ReadInputRegisters, reply, value) != Modbus::ReplyStatus::Ok || value < WBMSW_OCCUPANCY_THRESHOLD)
                 break;
 
             m_endpoints.value(0)->buffer().insert("occupancy", true);
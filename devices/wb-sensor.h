@@ -23,10 +23,6 @@ namespace WirenBoard
         QByteArray pollRequest(void) override;
         void parseReply(const QByteArray &reply) override;
 
-    private:
-
-        quint16 m_singleClick[2], m_hold[2], m_doubleClick[2];
-
     };
 
     class WBMs : public DeviceObject
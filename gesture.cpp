@@ -0,0 +1,92 @@
+#include "device.h"
+#include "gesture.h"
+
+GestureEngine::GestureEngine(QObject *parent) : QObject(parent), m_timer(new QTimer(this))
+{
+    connect(m_timer, &QTimer::timeout, this, &GestureEngine::expired);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+}
+
+void GestureEngine::update(DeviceObject *device, quint8 endpointId, bool status)
+{
+    Key key(device, endpointId);
+    auto it = m_channels.find(key);
+
+    if (it == m_channels.end() || it.value().device.isNull())
+    {
+        if (it != m_channels.end())
+            m_deadlines.remove(it.value().deadline, key);
+
+        it = m_channels.insert(key, {device, 0, 0, false, false});
+    }
+
+    it.value().status = status;
+
+    if (!status)
+        it.value().count++;
+
+    schedule(key, it.value(), QDateTime::currentMSecsSinceEpoch() + (status ? GESTURE_HOLD_TIMEOUT : GESTURE_CLICK_TIMEOUT));
+}
+
+void GestureEngine::schedule(const Key &key, Channel &channel, qint64 deadline)
+{
+    if (channel.deadline)
+        m_deadlines.remove(channel.deadline, key);
+
+    channel.deadline = deadline;
+
+    if (deadline)
+        m_deadlines.insert(deadline, key);
+
+    if (m_deadlines.isEmpty())
+    {
+        m_timer->stop();
+        return;
+    }
+
+    m_timer->start(static_cast <int> (qMax <qint64> (m_deadlines.firstKey() - QDateTime::currentMSecsSinceEpoch(), 0)));
+}
+
+void GestureEngine::expired(void)
+{
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+
+    while (!m_deadlines.isEmpty() && m_deadlines.firstKey() <= time)
+    {
+        Key key = m_deadlines.first();
+        auto it = m_channels.find(key);
+
+        m_deadlines.erase(m_deadlines.begin());
+
+        if (it == m_channels.end())
+            continue;
+
+        if (it.value().device.isNull())
+        {
+            m_channels.erase(it);
+            continue;
+        }
+
+        Channel &channel = it.value();
+        QString action;
+
+        if (!channel.status)
+        {
+            action = channel.count < 2 ? channel.hold ? "release" : "singleClick" : "doubleClick";
+            channel.hold = false;
+        }
+        else
+        {
+            action = "hold";
+            channel.hold = true;
+        }
+
+        channel.count = 0;
+        channel.deadline = 0;
+        channel.device->publishEvent(key.second, "action", action);
+    }
+
+    if (!m_deadlines.isEmpty())
+        m_timer->start(static_cast <int> (qMax <qint64> (m_deadlines.firstKey() - time, 0)));
+}
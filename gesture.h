@@ -0,0 +1,47 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#define GESTURE_CLICK_TIMEOUT   200
+#define GESTURE_HOLD_TIMEOUT    1000
+
+#include <QMap>
+#include <QPointer>
+#include <QTimer>
+
+class DeviceObject;
+
+class GestureEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    GestureEngine(QObject *parent = nullptr);
+
+    void update(DeviceObject *device, quint8 endpointId, bool status);
+
+private:
+
+    typedef QPair <DeviceObject*, quint8> Key;
+
+    struct Channel
+    {
+        QPointer <DeviceObject> device;
+        qint64 deadline;
+        quint8 count;
+        bool status, hold;
+    };
+
+    QTimer *m_timer;
+    QMap <Key, Channel> m_channels;
+    QMultiMap <qint64, Key> m_deadlines;
+
+    void schedule(const Key &key, Channel &channel, qint64 deadline);
+
+private slots:
+
+    void expired(void);
+
+};
+
+#endif
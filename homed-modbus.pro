@@ -18,8 +18,12 @@ HEADERS += \
     devices/wb-map.h \
     devices/wb-relay.h \
     devices/wb-sensor.h \
+    gesture.h \
     modbus.h \
-    port.h
+    port.h \
+    ring.h \
+    simulator.h \
+    statistics.h
 
 SOURCES += \
     controller.cpp \
@@ -36,7 +40,10 @@ SOURCES += \
     devices/wb-map.cpp \
     devices/wb-relay.cpp \
     devices/wb-sensor.cpp \
+    gesture.cpp \
     modbus.cpp \
-    port.cpp
+    port.cpp \
+    simulator.cpp \
+    statistics.cpp
 
 QT += serialport
@@ -61,9 +61,119 @@ qint64 Modbus::toInt64LE(const quint16 *data)
     return static_cast <qint64> (toUInt64LE(data));
 }
 
-QByteArray Modbus::makeRequest(quint8 slaveAddress, FunctionCode functionCode, quint16 registerAddress, quint16 registerValue, quint16 *registerData)
+double Modbus::frameTime(int length, quint32 baudRate)
 {
-    QByteArray request;    
+    return length * 10000.0 / baudRate;
+}
+
+double Modbus::silentInterval(quint32 baudRate)
+{
+    return baudRate > 19200 ? 1.75 : 38500.0 / baudRate;
+}
+
+int Modbus::frameLength(const QByteArray &request, bool tcp)
+{
+    return tcp ? request.length() - 4 : request.length();
+}
+
+int Modbus::replyLength(const QByteArray &request, bool tcp)
+{
+    int offset = tcp ? 6 : 0;
+    quint16 count;
+
+    if (request.length() < offset + 6)
+        return 0;
+
+    count = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + offset + 4)));
+
+    switch (static_cast <FunctionCode> (request.at(offset + 1)))
+    {
+        case ReadCoilStatus:
+        case ReadInputStatus:
+            return 5 + (count + 7) / 8;
+
+        case ReadHoldingRegisters:
+        case ReadInputRegisters:
+        case ReadWriteMultipleRegisters:
+            return 5 + count * 2;
+
+        case WriteSingleCoil:
+        case WriteSingleRegister:
+        case WriteMultipleCoils:
+        case WriteMultipleRegisters:
+            return 8;
+
+        default:
+            return 0;
+    }
+}
+
+bool Modbus::matchReply(const QByteArray &request, const QByteArray &reply)
+{
+    if (request.length() < 4 || reply.length() < 4 || reply.at(0) != request.at(0) || (reply.at(1) & 0x7F) != request.at(1))
+        return false;
+
+    if (reply.at(1) & 0x80)
+        return reply.length() == 5;
+
+    switch (static_cast <FunctionCode> (request.at(1)))
+    {
+        case ReadCoilStatus:
+        case ReadInputStatus:
+        case ReadHoldingRegisters:
+        case ReadInputRegisters:
+        case ReadWriteMultipleRegisters:
+            return reply.length() == replyLength(request, false) && static_cast <quint8> (reply.at(2)) == reply.length() - 5;
+
+        case WriteSingleCoil:
+        case WriteSingleRegister:
+            return reply == request;
+
+        case WriteMultipleCoils:
+        case WriteMultipleRegisters:
+            return reply.length() == 8 && request.length() >= 8 && reply.mid(2, 4) == request.mid(2, 4);
+
+        default:
+            return true;
+    }
+}
+
+QByteArray Modbus::fastRequest(quint8 slaveAddress, FastCommand command, const QByteArray &payload)
+{
+    QByteArray request;
+    quint16 crc;
+
+    request.append(static_cast <char> (slaveAddress));
+    request.append(static_cast <char> (FastModbus));
+    request.append(static_cast <char> (command));
+
+    if (command == EventControl)
+        request.append(static_cast <char> (payload.length()));
+
+    request.append(payload);
+    crc = qToLittleEndian(crc16(request));
+
+    return request.append(reinterpret_cast <char*> (&crc), sizeof(crc));
+}
+
+QByteArray Modbus::eventBlock(EventType type, quint16 address, quint8 count, quint8 priority)
+{
+    quint16 value = qToBigEndian(address);
+    QByteArray block;
+
+    block.append(static_cast <char> (type));
+    block.append(reinterpret_cast <char*> (&value), sizeof(value));
+    block.append(static_cast <char> (count));
+
+    return block.append(count, static_cast <char> (priority));
+}
+
+QByteArray Modbus::makeRequest(quint8 slaveAddress, FunctionCode functionCode, quint16 registerAddress, quint16 registerValue, quint16 *registerData, quint16 writeAddress, quint16 writeCount)
+{
+    QByteArray request;
+
+    if ((functionCode == WriteMultipleCoils && registerValue > MAX_WRITE_COILS) || (functionCode == WriteMultipleRegisters && registerValue > MAX_WRITE_REGISTERS) || (functionCode == ReadWriteMultipleRegisters && (registerValue > MAX_READ_WRITE_READ || writeCount > MAX_READ_WRITE_WRITE)))
+        return request;
 
     request.append(static_cast <char> (slaveAddress));
     request.append(static_cast <char> (functionCode));
@@ -75,6 +185,22 @@ QByteArray Modbus::makeRequest(quint8 slaveAddress, FunctionCode functionCode, q
         request.append(reinterpret_cast <char*> (&address), sizeof(address));
         request.append(reinterpret_cast <char*> (&value), sizeof(value));
 
+        if (functionCode == WriteMultipleCoils && registerData)
+        {
+            request.append(static_cast <char> ((registerValue + 7) / 8));
+
+            for (quint16 i = 0; i < registerValue; i += 8)
+            {
+                quint8 data = 0;
+
+                for (quint16 j = i; j < i + 8 && j < registerValue; j++)
+                    if (registerData[j])
+                        data |= 1 << (j - i);
+
+                request.append(static_cast <char> (data));
+            }
+        }
+
         if (functionCode == WriteMultipleRegisters && registerData)
         {
             request.append(static_cast <char> (registerValue * 2));
@@ -85,6 +211,21 @@ QByteArray Modbus::makeRequest(quint8 slaveAddress, FunctionCode functionCode, q
                 request.append(reinterpret_cast <char*> (&data), sizeof(data));
             }
         }
+
+        if (functionCode == ReadWriteMultipleRegisters && registerData)
+        {
+            quint16 address = qToBigEndian(writeAddress), count = qToBigEndian(writeCount);
+
+            request.append(reinterpret_cast <char*> (&address), sizeof(address));
+            request.append(reinterpret_cast <char*> (&count), sizeof(count));
+            request.append(static_cast <char> (writeCount * 2));
+
+            for (quint16 i = 0; i < writeCount; i++)
+            {
+                quint16 data = qToBigEndian(registerData[i]);
+                request.append(reinterpret_cast <char*> (&data), sizeof(data));
+            }
+        }
     }
 
     if (m_tcp)
@@ -99,17 +240,28 @@ QByteArray Modbus::makeRequest(quint8 slaveAddress, FunctionCode functionCode, q
     }
 }
 
-Modbus::ReplyStatus Modbus::parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply, quint16 *registerData)
+void Modbus::updateSequence(QByteArray &request)
 {
+    quint16 sequence = qToBigEndian(m_sequence);
+
+    if (!m_tcp || request.length() < 2)
+        return;
+
+    request.replace(0, 2, reinterpret_cast <char*> (&sequence), sizeof(sequence));
+}
+
+Modbus::ReplyStatus Modbus::parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply, quint16 *registerData, int registerCount)
+{
+    int offset = m_tcp ? 6 : 0, length = m_tcp ? reply.length() : reply.length() - 2;
     QByteArray data;
 
     if (reply.length() < (m_tcp ? 8 : 4))
         return WrongLength;
 
-    if (slaveAddress != static_cast <quint8> (reply.at(m_tcp ? 6 : 0)))
+    if (slaveAddress != static_cast <quint8> (reply.at(offset)))
         return WrongSlaveAddress;
 
-    if (functionCode != static_cast <FunctionCode> (reply.at(m_tcp ? 7 : 1) & 0x7F))
+    if (functionCode != static_cast <FunctionCode> (reply.at(offset + 1) & 0x7F))
         return WrongFunctionCode;
 
     if (m_tcp && qFromBigEndian(*(reinterpret_cast <const quint16*> (reply.constData()))) != m_sequence)
@@ -118,10 +270,13 @@ Modbus::ReplyStatus Modbus::parseReply(quint8 slaveAddress, FunctionCode functio
     if (!m_tcp && qFromLittleEndian(*(reinterpret_cast <const quint16*> (reply.mid(reply.length() - 2).constData()))) != crc16(reply.mid(0, reply.length() - 2)))
         return BadCRC;
 
-    if (reply.at(m_tcp ? 7 : 1) & 0x80)
+    if (reply.at(offset + 1) & 0x80)
     {
-        if (registerData)
-            *registerData = reply.at(2);
+        if (length < offset + 3)
+            return WrongLength;
+
+        if (registerData && registerCount)
+            *registerData = static_cast <quint8> (reply.at(offset + 2));
 
         return Exception;
     }
@@ -133,27 +288,37 @@ Modbus::ReplyStatus Modbus::parseReply(quint8 slaveAddress, FunctionCode functio
         case ReadHoldingRegisters:
         case ReadInputRegisters:
         case ReportSlaveId:
-            data = reply.mid(m_tcp ? 9 : 3, static_cast <int> (reply.at(m_tcp ? 8 : 2)));
+        case ReadWriteMultipleRegisters:
+
+            if (length < offset + 3 || length < offset + 3 + static_cast <quint8> (reply.at(offset + 2)))
+                return WrongLength;
+
+            data = reply.mid(offset + 3, static_cast <quint8> (reply.at(offset + 2)));
             break;
 
         case WriteSingleCoil:
         case WriteSingleRegister:
+        case WriteMultipleCoils:
         case WriteMultipleRegisters:
-            data = reply.mid(m_tcp ? 8 : 2, reply.length() - (m_tcp ? 8 : 4));
+            data = reply.mid(offset + 2, length - offset - 2);
             break;
     }
 
-    if (registerData)
+    if (registerData && registerCount)
     {
         if (functionCode != ReportSlaveId)
         {
             bool check = functionCode == ReadCoilStatus || functionCode == ReadInputStatus;
+            int count = check ? qMin(data.length() * 8, registerCount) : data.length() / 2;
+
+            if (count > registerCount)
+                return WrongLength;
 
-            for (int i = 0; i < (check ? data.length() * 8 : data.length() / 2); i++)
+            for (int i = 0; i < count; i++)
                 registerData[i] = check ? data.at(i / 8) & 1 << i % 8 ? 1 : 0 : qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (data.constData() + i * 2)));
         }
         else
-            memcpy(registerData, data.constData(), data.length());
+            memcpy(registerData, data.constData(), qMin(data.length(), registerCount * 2));
     }
 
     if (m_tcp)
@@ -174,3 +339,8 @@ quint16 Modbus::crc16(const QByteArray &data)
 
     return crc;
 }
+
+bool Modbus::checkCrc(const QByteArray &frame)
+{
+    return frame.length() >= 4 && qFromLittleEndian <quint16> (*(reinterpret_cast <const quint16*> (frame.constData() + frame.length() - 2))) == crc16(frame.left(frame.length() - 2));
+}
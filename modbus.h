@@ -1,6 +1,12 @@
 #ifndef MODBUS_H
 #define MODBUS_H
 
+#define FAST_MODBUS_BROADCAST       0xFD
+#define MAX_WRITE_COILS             1968
+#define MAX_WRITE_REGISTERS         123
+#define MAX_READ_WRITE_READ         125
+#define MAX_READ_WRITE_WRITE        121
+
 #include <QByteArray>
 
 class Modbus
@@ -10,14 +16,40 @@ public:
 
     enum FunctionCode
     {
-        ReadCoilStatus          = 0x01,
-        ReadInputStatus         = 0x02,
-        ReadHoldingRegisters    = 0x03,
-        ReadInputRegisters      = 0x04,
-        WriteSingleCoil         = 0x05,
-        WriteSingleRegister     = 0x06,
-        WriteMultipleRegisters  = 0x10,
-        ReportSlaveId           = 0x11
+        ReadCoilStatus              = 0x01,
+        ReadInputStatus             = 0x02,
+        ReadHoldingRegisters        = 0x03,
+        ReadInputRegisters          = 0x04,
+        WriteSingleCoil             = 0x05,
+        WriteSingleRegister         = 0x06,
+        WriteMultipleCoils          = 0x0F,
+        WriteMultipleRegisters      = 0x10,
+        ReportSlaveId               = 0x11,
+        ReadWriteMultipleRegisters  = 0x17,
+        FastModbus                  = 0x46
+    };
+
+    enum FastCommand
+    {
+        ScanStart                   = 0x01,
+        ScanContinue                = 0x02,
+        ScanReply                   = 0x03,
+        ScanEnd                     = 0x04,
+        SerialRequest               = 0x08,
+        SerialReply                 = 0x09,
+        EventRequest                = 0x10,
+        EventReply                  = 0x11,
+        NoEvents                    = 0x12,
+        EventControl                = 0x18
+    };
+
+    enum EventType
+    {
+        CoilEvent                   = 0x01,
+        DiscreteEvent               = 0x02,
+        HoldingEvent                = 0x03,
+        InputEvent                  = 0x04,
+        SystemEvent                 = 0x0F
     };
 
     enum ExceptionCode
@@ -55,16 +87,31 @@ public:
     static qint64 toInt64BE(const quint16 *data);
     static qint64 toInt64LE(const quint16 *data);
 
-    QByteArray makeRequest(quint8 slaveAddress, FunctionCode functionCode, quint16 registerAddress = 0, quint16 registerValue = 0, quint16 *registerData = nullptr);
-    ReplyStatus parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply, quint16 *registerData = nullptr);
+    static quint16 crc16(const QByteArray &data);
+    static bool checkCrc(const QByteArray &frame);
+
+    static double frameTime(int length, quint32 baudRate);
+    static double silentInterval(quint32 baudRate);
+    static int frameLength(const QByteArray &request, bool tcp);
+    static int replyLength(const QByteArray &request, bool tcp);
+    static bool matchReply(const QByteArray &request, const QByteArray &reply);
+
+    static QByteArray fastRequest(quint8 slaveAddress, FastCommand command, const QByteArray &payload);
+    static QByteArray eventBlock(EventType type, quint16 address, quint8 count, quint8 priority = 1);
+
+    QByteArray makeRequest(quint8 slaveAddress, FunctionCode functionCode, quint16 registerAddress = 0, quint16 registerValue = 0, quint16 *registerData = nullptr, quint16 writeAddress = 0, quint16 writeCount = 0);
+    void updateSequence(QByteArray &request);
+    ReplyStatus parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply, quint16 *registerData, int registerCount);
+
+    inline ReplyStatus parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply) { return parseReply(slaveAddress, functionCode, reply, nullptr, 0); }
+    inline ReplyStatus parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply, quint16 &registerData) { return parseReply(slaveAddress, functionCode, reply, &registerData, 1); }
+    template <int count> inline ReplyStatus parseReply(quint8 slaveAddress, FunctionCode functionCode, const QByteArray &reply, quint16 (&registerData)[count]) { return parseReply(slaveAddress, functionCode, reply, registerData, count); }
 
 private:
 
     quint16 m_sequence;
     bool m_tcp;
 
-    quint16 crc16(const QByteArray &data);
-
 };
 
 #endif
@@ -1,18 +1,77 @@
+#include <math.h>
 #include <netinet/tcp.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#endif
 #include <QtEndian>
+#include <QElapsedTimer>
 #include <QEventLoop>
+#include <QJsonArray>
+#include <QRandomGenerator>
 #include <QSerialPort>
 #include "logger.h"
 #include "device.h"
 #include "port.h"
 
-PortThread::PortThread(quint8 portId, const QString &portName, bool tcp, bool rfc, bool debug, DeviceList *devices) : QThread(nullptr), m_portId(portId), m_portName(portName), m_tcp(tcp), m_rfc(rfc), m_debug(debug), m_serialError(false), m_busy(false), m_connected(false), m_rfcMode(RFCMode::Disabled), m_devices(devices)
+PortThread::PortThread(quint8 portId, QSettings *config, DeviceList *devices) : QThread(nullptr), m_portId(portId), m_serialError(false), m_busy(false), m_connected(false), m_rfcMode(RFCMode::Disabled), m_replyTimeout(REPLY_TIMEOUT), m_devices(devices)
 {
+    QString section = QString("port-%1").arg(portId);
+
+    m_portName = config->value(QString("%1/port").arg(section)).toString();
+    m_tcp = config->value(QString("%1/tcp").arg(section), false).toBool();
+    m_rfc = config->value(QString("%1/rfc").arg(section), false).toBool();
+    m_debug = config->value(QString("%1/debug").arg(section), false).toBool();
+    m_rtuTiming = config->value(QString("%1/rtuTiming").arg(section), false).toBool();
+    m_lowLatency = config->value(QString("%1/lowLatency").arg(section), false).toBool();
+    m_sniffer = config->value(QString("%1/sniffer").arg(section), false).toBool();
+    m_baudRate = m_sniffer ? config->value(QString("%1/baudRate").arg(section), 9600).toInt() : 0;
+
+    m_retryCount = static_cast <quint8> (config->value(QString("%1/retryCount").arg(section), 3).toInt());
+    m_retryDelay = config->value(QString("%1/retryDelay").arg(section), 50).toInt();
+    m_retryJitter = config->value(QString("%1/retryJitter").arg(section), 20).toInt();
+    m_offlineDelay = config->value(QString("%1/offlineDelay").arg(section), 5000).toInt();
+    m_offlineLimit = config->value(QString("%1/offlineLimit").arg(section), 300000).toInt();
+
+    m_turnaroundDelay = config->value(QString("%1/turnaroundDelay").arg(section), 100).toInt();
+
+    m_adaptiveTimeout = config->value(QString("%1/adaptiveTimeout").arg(section), false).toBool();
+    m_timeoutFloor = config->value(QString("%1/timeoutFloor").arg(section), 50).toInt();
+    m_timeoutCeiling = config->value(QString("%1/timeoutCeiling").arg(section), 0).toInt();
+
+    m_probeInterval = config->value(QString("%1/probeInterval").arg(section), 1000).toInt();
+    m_probeTime = 0;
+
+    m_statisticsInterval = config->value(QString("%1/statisticsInterval").arg(section), 60000).toInt();
+
+    m_loadShedding = config->value(QString("%1/loadShedding").arg(section), false).toBool();
+    m_sheddingThreshold = config->value(QString("%1/sheddingThreshold").arg(section), 80).toDouble() / 100;
+    m_load = 0;
+    m_stretch = 1;
+    m_loadTime = 0;
+    m_loadBusy = 0;
+    m_overruns = 0;
+    m_capacityPending = false;
+
+    m_fastModbus = config->value(QString("%1/fastModbus").arg(section), false).toBool();
+    m_eventInterval = config->value(QString("%1/eventInterval").arg(section), 50).toInt();
+    m_eventTimeout = config->value(QString("%1/eventTimeout").arg(section), 100).toInt();
+    m_eventTime = 0;
+    m_eventConfirm = QByteArray(2, 0x00);
+
+    m_scanPending = false;
+    m_scanResolve = false;
+    m_scanBaudRate = 0;
+    m_scanActive = false;
+
+    m_replyLength = 0;
+    m_captureTime = 0;
+
     connect(this, &PortThread::started, this, &PortThread::threadStarted);
     connect(this, &PortThread::finished, this, &PortThread::threadFinished);
 
     moveToThread(this);
-    start();
 }
 
 PortThread::~PortThread(void)
@@ -21,9 +80,63 @@ PortThread::~PortThread(void)
     wait();
 }
 
+QJsonObject PortThread::capacity(quint8 portId, const QList <Device> &devices, bool tcp)
+{
+    QJsonObject json, items;
+    double utilization = 0;
+
+    for (int i = 0; i < devices.count(); i++)
+    {
+        const Device &device = devices.at(i);
+        QList <QByteArray> program;
+        QList <quint8> sequence;
+        QList <double> frames;
+        double time = 0, load = 0, period, share;
+
+        if (device->portId() != portId || !device->active() || device->broadcast())
+            continue;
+
+        device->modbus()->setTcp(tcp);
+        program = device->pollProgram(&sequence);
+
+        for (int j = 0; j < program.count(); j++)
+        {
+            const QByteArray &request = program.at(j);
+            int length = Modbus::replyLength(request, tcp);
+            frames.append(Modbus::frameTime(Modbus::frameLength(request, tcp) + (length ? length : 8), device->baudRate()) + Modbus::silentInterval(device->baudRate()) * 2);
+            time += frames.last();
+        }
+
+        period = time + device->pollInterval();
+
+        for (int j = 0; j < frames.count(); j++)
+        {
+            quint32 interval = device->stepInterval(sequence.at(j));
+            load += interval > period ? frames.at(j) * period / interval : frames.at(j);
+        }
+
+        share = load ? load / (load + device->pollInterval()) : 0;
+        utilization += share;
+
+        items.insert(device->name(), QJsonObject {{"requests", program.count()}, {"sweep", round(time * 10) / 10}, {"pollInterval", device->pollInterval()}, {"utilization", round(share * 1000) / 10}});
+    }
+
+    json.insert("devices", items);
+    json.insert("utilization", round(utilization * 1000) / 10);
+    json.insert("feasible", utilization <= 1);
+
+    return json;
+}
+
 void PortThread::init(void)
 {
-    m_baudRate = 0;
+    if (m_sniffer)
+    {
+        m_replyTimeout = static_cast <quint32> (ceil(Modbus::silentInterval(m_baudRate)));
+        m_serial->setBaudRate(m_baudRate);
+    }
+    else
+        m_baudRate = 0;
 
     if (m_device == m_serial)
     {
@@ -37,7 +150,18 @@ void PortThread::init(void)
         }
 
         logInfo << this << "serial port" << m_serial->portName() << "opened successfully";
+
+        if (m_lowLatency)
+            setLowLatency();
+
         m_serial->clear();
+
+        if (m_sniffer)
+        {
+            logInfo << this << "listening in sniffer mode";
+            return;
+        }
+
         m_pollTimer->start(1);
     }
     else
@@ -111,9 +235,76 @@ void PortThread::rfcRequest(qint32 baudRate)
     }
 }
 
+void PortThread::setLowLatency(void)
+{
+#ifdef __linux__
+    int descriptor = static_cast <int> (m_serial->handle());
+    struct serial_struct serial;
+    struct termios options;
+
+    if (!ioctl(descriptor, TIOCGSERIAL, &serial))
+    {
+        serial.flags |= ASYNC_LOW_LATENCY;
+
+        if (ioctl(descriptor, TIOCSSERIAL, &serial))
+            logDebug(m_debug) << this << "unable to enable low latency mode";
+    }
+
+    if (!tcgetattr(descriptor, &options))
+    {
+        options.c_cc[VMIN] = 0;
+        options.c_cc[VTIME] = 0;
+        tcsetattr(descriptor, TCSANOW, &options);
+    }
+#else
+    logDebug(m_debug) << this << "low latency mode is not supported on this platform";
+#endif
+}
+
+void PortThread::updateBaudRate(qint32 baudRate)
+{
+    if (m_baudRate == baudRate)
+        return;
+
+    if (m_device == m_serial)
+        m_serial->setBaudRate(baudRate);
+    else
+        rfcRequest(baudRate);
+
+    m_baudRate = baudRate;
+}
+
+bool PortThread::sendFrame(const QByteArray &request, qint64 timeout)
+{
+    QElapsedTimer elapsed;
+    QEventLoop loop;
+    QTimer timer;
+
+    connect(this, &PortThread::replyReceived, &loop, &QEventLoop::quit);
+    connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+    m_replyData.clear();
+    m_replyLength = 0;
+
+    m_device->write(request);
+    logDebug(m_debug) << this << "serial data sent:" << request.toHex(':');
+
+    timer.setSingleShot(true);
+    timer.start(timeout);
+
+    elapsed.start();
+    loop.exec();
+
+    m_frameTimer.start();
+    m_loadBusy += elapsed.elapsed();
+
+    return timer.isActive();
+}
+
 void PortThread::sendRequest(const Device &device, const QByteArray &request)
 {
     Availability availability = device->availability();
+    QElapsedTimer elapsed;
     QEventLoop loop;
     QTimer timer;
 
@@ -121,40 +312,306 @@ void PortThread::sendRequest(const Device &device, const QByteArray &request)
     connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
 
     m_replyData.clear();
-    m_replyTimeout = device->replyTimeout();
+    m_replyLength = m_tcp ? 0 : Modbus::replyLength(request, false);
+    m_replyTimeout = m_rtuTiming && m_device == m_serial ? static_cast <quint32> (ceil(Modbus::silentInterval(device->baudRate()))) : device->replyTimeout();
+
+    updateBaudRate(device->baudRate());
 
-    if (m_baudRate != device->baudRate())
+    if (m_rtuTiming && m_device == m_serial && m_frameTimer.isValid())
     {
-        if (m_device == m_serial)
-            m_serial->setBaudRate(device->baudRate());
-        else
-            rfcRequest(device->baudRate());
+        qint64 delay = static_cast <qint64> (Modbus::silentInterval(device->baudRate()) * 1000) - m_frameTimer.nsecsElapsed() / 1000;
 
-        m_baudRate = device->baudRate();
+        if (delay > 0)
+            QThread::usleep(static_cast <unsigned long> (delay));
     }
 
     m_device->write(request);
     logDebug(m_debug) << this << "serial data sent:" << request.toHex(':');
 
     timer.setSingleShot(true);
-    timer.start(device->requestTimeout());
+    timer.start(requestTimeout(device));
 
+    elapsed.start();
     loop.exec();
 
+    m_frameTimer.start();
+
+    updateStatistics(device, request, elapsed.elapsed(), !timer.isActive());
+    m_loadBusy += elapsed.elapsed();
+
     if (!timer.isActive())
+    {
         device->increaseErrorCount();
+        device->setRetryTime(QDateTime::currentMSecsSinceEpoch() + retryDelay(device));
+    }
     else
+    {
         device->resetErrorCount();
+        device->updateRtt(elapsed.elapsed());
+    }
 
-    device->setAvailability(device->errorCount() > 2 ? Availability::Offline : Availability::Online);
+    device->setAvailability(device->errorCount() >= OFFLINE_ERROR_COUNT ? Availability::Offline : Availability::Online);
 
     if (availability == device->availability())
         return;
 
     if (device->availability() == Availability::Offline)
+    {
+        device->setEvents(false);
+        device->setEventsChecked(false);
         device->resetPoll();
+    }
 
-    emit updateAvailability(device.data());
+    emit updateAvailability(device);
+}
+
+void PortThread::sendBroadcast(const Device &device, const QByteArray &request)
+{
+    QEventLoop loop;
+    QTimer timer;
+
+    connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+    updateBaudRate(device->baudRate());
+
+    m_device->write(request);
+    logDebug(m_debug) << this << "broadcast data sent:" << request.toHex(':');
+
+    timer.setSingleShot(true);
+    timer.start(m_turnaroundDelay);
+    loop.exec();
+
+    m_frameTimer.start();
+    m_replyData.clear();
+
+    m_loadBusy += m_turnaroundDelay;
+
+    if (device->availability() == Availability::Online)
+        return;
+
+    device->setAvailability(Availability::Online);
+    emit updateAvailability(device);
+}
+
+void PortThread::captureFrame(const QByteArray &frame)
+{
+    QList <Device> list = m_devices->snapshot();
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+    QByteArray request = m_captureRequest;
+
+    logDebug(m_debug) << this << "captured data:" << frame.toHex(':');
+
+    if (!Modbus::checkCrc(frame))
+    {
+        m_statistics.crcError();
+        m_captureRequest.clear();
+        return;
+    }
+
+    if (request.isEmpty() || !Modbus::matchReply(request, frame))
+    {
+        m_captureRequest = frame;
+        m_captureTime = time;
+        return;
+    }
+
+    m_captureRequest.clear();
+    m_statistics.transaction(request.length(), frame.length(), time - m_captureTime);
+
+    if (frame.at(1) & 0x80)
+        m_statistics.exception(static_cast <quint8> (frame.at(2)));
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        const Device &device = list.at(i);
+
+        if (device->portId() != m_portId || device->slaveId() != static_cast <quint8> (frame.at(0)) || !device->active())
+            continue;
+
+        device->modbus()->setTcp(false);
+        device->setGestures(m_gestures);
+        device->statistics().transaction(request.length(), frame.length(), time - m_captureTime);
+
+        if (!device->parseCapture(request, frame) || device->availability() == Availability::Online)
+            continue;
+
+        device->setAvailability(Availability::Online);
+        emit updateAvailability(device);
+    }
+}
+
+void PortThread::pollEvents(void)
+{
+    QList <Device> list = m_devices->snapshot();
+    Device first;
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        const Device &device = list.at(i);
+
+        if (device->portId() != m_portId || !device->active() || !device->events())
+            continue;
+
+        first = device;
+        break;
+    }
+
+    if (first.isNull())
+        return;
+
+    updateBaudRate(first->baudRate());
+
+    for (int i = 0; i < EVENT_BATCH_COUNT; i++)
+    {
+        QByteArray payload = QByteArray(1, 0x01).append(static_cast <char> (EVENT_MAX_LENGTH)).append(m_eventConfirm);
+        Device device;
+        int offset = 6, length;
+
+        if (!sendFrame(Modbus::fastRequest(FAST_MODBUS_BROADCAST, Modbus::EventRequest, payload), m_eventTimeout) || m_replyData.length() < 5)
+            break;
+
+        if (!Modbus::checkCrc(m_replyData))
+        {
+            m_statistics.crcError();
+            break;
+        }
+
+        if (m_replyData.at(1) != Modbus::FastModbus || m_replyData.at(2) != Modbus::EventReply || m_replyData.length() < 8)
+            break;
+
+        m_eventConfirm = m_replyData.mid(0, 1).append(m_replyData.at(3));
+        length = qMin(offset + static_cast <quint8> (m_replyData.at(5)), m_replyData.length() - 2);
+
+        for (int j = 0; j < list.count(); j++)
+        {
+            const Device &item = list.at(j);
+
+            if (item->portId() != m_portId || item->slaveId() != static_cast <quint8> (m_replyData.at(0)) || !item->active())
+                continue;
+
+            device = item;
+            break;
+        }
+
+        if (device.isNull())
+            continue;
+
+        while (offset + 4 <= length)
+        {
+            quint8 size = static_cast <quint8> (m_replyData.at(offset)), type = static_cast <quint8> (m_replyData.at(offset + 1));
+            quint16 address = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (m_replyData.constData() + offset + 2)));
+            QByteArray data = m_replyData.mid(offset + 4, qMin <int> (size, length - offset - 4));
+
+            offset += 4 + size;
+
+            if (type == Modbus::SystemEvent)
+            {
+                logDebug(m_debug) << this << device << "restarted, events subscription reset";
+                device->setEvents(false);
+                device->setEventsChecked(false);
+                device->resetPoll();
+                continue;
+            }
+
+            device->parseEvent(type, address, data);
+        }
+    }
+}
+
+QByteArray PortThread::serialRequest(quint32 serial, const QByteArray &request)
+{
+    quint32 value = qToBigEndian(serial);
+    QByteArray payload = QByteArray(reinterpret_cast <char*> (&value), sizeof(value)).append(request);
+
+    if (!sendFrame(Modbus::fastRequest(FAST_MODBUS_BROADCAST, Modbus::SerialRequest, payload), m_eventTimeout) || m_replyData.length() < 10 || !Modbus::checkCrc(m_replyData))
+        return QByteArray();
+
+    if (m_replyData.at(1) != Modbus::FastModbus || m_replyData.at(2) != Modbus::SerialReply || m_replyData.mid(3, 4) != payload.left(4))
+        return QByteArray();
+
+    return m_replyData.mid(7, m_replyData.length() - 9);
+}
+
+qint64 PortThread::retryDelay(const Device &device)
+{
+    quint32 count = device->errorCount();
+
+    if (count >= OFFLINE_ERROR_COUNT)
+    {
+        count -= OFFLINE_ERROR_COUNT;
+        return qMin <qint64> (static_cast <qint64> (m_offlineDelay) << qMin <quint32> (count, 16), m_offlineLimit);
+    }
+
+    return (static_cast <qint64> (m_retryDelay) << (count - 1)) + (m_retryJitter ? QRandomGenerator::global()->bounded(m_retryJitter + 1) : 0);
+}
+
+qint64 PortThread::requestTimeout(const Device &device)
+{
+    qint64 ceiling = m_timeoutCeiling ? m_timeoutCeiling : device->requestTimeout();
+
+    if (!m_adaptiveTimeout || !device->rtt())
+        return device->requestTimeout();
+
+    return qBound <qint64> (m_timeoutFloor, static_cast <qint64> (ceil(device->rtt() + qMax(1.0, 4 * device->rttVariance()))) << qMin <quint32> (device->errorCount(), 4), ceiling);
+}
+
+void PortThread::updateStatistics(const Device &device, const QByteArray &request, qint64 elapsed, bool timeout)
+{
+    int offset = m_tcp ? 7 : 1;
+
+    if (timeout)
+    {
+        device->statistics().timeout(request.length(), elapsed);
+        m_statistics.timeout(request.length(), elapsed);
+        return;
+    }
+
+    device->statistics().transaction(request.length(), m_replyData.length(), elapsed);
+    m_statistics.transaction(request.length(), m_replyData.length(), elapsed);
+
+    if (!m_tcp && qFromLittleEndian(*(reinterpret_cast <const quint16*> (m_replyData.constData() + m_replyData.length() - 2))) != Modbus::crc16(m_replyData.left(m_replyData.length() - 2)))
+    {
+        device->statistics().crcError();
+        m_statistics.crcError();
+        return;
+    }
+
+    if (m_replyData.length() <= offset + 1 || !(m_replyData.at(offset) & 0x80))
+        return;
+
+    device->statistics().exception(static_cast <quint8> (m_replyData.at(offset + 1)));
+    m_statistics.exception(static_cast <quint8> (m_replyData.at(offset + 1)));
+}
+
+void PortThread::updateLoad(void)
+{
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+    double stretch = m_stretch;
+
+    if (!m_loadTime)
+        m_loadTime = time;
+
+    if (time - m_loadTime < LOAD_WINDOW)
+        return;
+
+    m_load = static_cast <double> (m_loadBusy) / (time - m_loadTime);
+
+    if (m_loadShedding)
+    {
+        m_stretch = qBound(1.0, m_overruns ? m_stretch * 2 : m_stretch * m_load / m_sheddingThreshold, static_cast <double> (SHEDDING_LIMIT));
+
+        if (qRound(m_stretch * 10) != qRound(stretch * 10))
+            logDebug(m_debug) << this << "low priority poll intervals stretched by" << QString::number(m_stretch, 'f', 1);
+    }
+
+    m_loadTime = time;
+    m_loadBusy = 0;
+    m_overruns = 0;
+}
+
+qint64 PortThread::pollInterval(const Device &device)
+{
+    return m_loadShedding && device->lowPriority() ? static_cast <qint64> (device->pollInterval() * m_stretch) : device->pollInterval();
 }
 
 void PortThread::threadStarted(void)
@@ -165,6 +622,8 @@ void PortThread::threadStarted(void)
     m_receiveTimer = new QTimer(this);
     m_resetTimer = new QTimer(this);
     m_pollTimer = new QTimer(this);
+    m_statisticsTimer = new QTimer(this);
+    m_gestures = new GestureEngine(this);
 
     if (!m_portName.startsWith("tcp://"))
     {
@@ -199,19 +658,25 @@ void PortThread::threadStarted(void)
     connect(m_receiveTimer, &QTimer::timeout, this, &PortThread::readyRead);
     connect(m_resetTimer, &QTimer::timeout, this, &PortThread::reset);
     connect(m_pollTimer, &QTimer::timeout, this, &PortThread::poll);
+    connect(m_statisticsTimer, &QTimer::timeout, this, &PortThread::statisticsTimeout);
 
     connect(this, &QThread::finished, m_resetTimer, &QTimer::deleteLater);
     connect(this, &QThread::finished, m_socket, &QTcpSocket::deleteLater);
 
     m_receiveTimer->setSingleShot(true);
+    m_receiveTimer->setTimerType(Qt::PreciseTimer);
     m_resetTimer->setSingleShot(true);
 
+    if (m_statisticsInterval)
+        m_statisticsTimer->start(m_statisticsInterval);
+
     init();
 }
 
 void PortThread::threadFinished(void)
 {
     m_pollTimer->stop();
+    m_statisticsTimer->stop();
 
     if (!m_connected)
         return;
@@ -250,19 +715,63 @@ void PortThread::socketConnected(void)
     if (m_rfc)
         rfcRequest();
 
-    m_pollTimer->start(1);
+    if (!m_sniffer)
+        m_pollTimer->start(1);
+
     m_connected = true;
 }
 
+int PortThread::expectedLength(void)
+{
+    int offset = m_tcp ? 7 : 1;
+
+    if (m_replyData.length() > offset && m_replyData.at(offset) & 0x80)
+        return m_tcp ? 9 : 5;
+
+    if (m_tcp && m_replyData.length() >= 6)
+        return qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (m_replyData.constData() + 4))) + 6;
+
+    return m_replyLength;
+}
+
 void PortThread::startTimer(void)
 {
+    int length;
+
     m_replyData.append(m_device->readAll());
+
+    if (m_sniffer)
+    {
+        m_receiveTimer->start(m_replyTimeout);
+        return;
+    }
+
+    length = expectedLength();
+
+    if (length && m_replyData.length() >= length)
+    {
+        m_receiveTimer->stop();
+        readyRead();
+        return;
+    }
+
     m_receiveTimer->start(m_replyTimeout);
 }
 
 void PortThread::readyRead(void)
 {
-    if (m_replyData.length() < 4)
+    int length;
+
+    if (m_sniffer)
+    {
+        captureFrame(m_replyData);
+        m_replyData.clear();
+        return;
+    }
+
+    length = expectedLength();
+
+    if (m_replyData.length() < (length ? length : 4))
         return;
 
     logDebug(m_debug) << this << "serial data received:" << m_replyData.toHex(':');
@@ -274,57 +783,504 @@ void PortThread::reset(void)
     init();
 }
 
+void PortThread::publishStatistics(void)
+{
+    emit statisticsUpdated(m_portId, statistics(QDateTime::currentMSecsSinceEpoch(), false));
+}
+
+QJsonObject PortThread::statistics(qint64 time, bool resetWindow)
+{
+    QList <Device> list = m_devices->snapshot();
+    QJsonObject json = m_statistics.json(time), devices;
+
+    if (resetWindow)
+        m_statistics.reset(time);
+
+    json.insert("load", round(m_load * 1000) / 10);
+
+    if (m_loadShedding)
+        json.insert("stretch", round(m_stretch * 10) / 10);
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        const Device &device = list.at(i);
+        QJsonObject item;
+
+        if (device->portId() != m_portId || !device->active())
+            continue;
+
+        item = device->statistics().json(time);
+        item.insert("pollInterval", device->pollInterval());
+
+        if (resetWindow)
+            device->statistics().reset(time);
+
+        if (device->rtt())
+            item.insert("srtt", round(device->rtt()));
+
+        devices.insert(device->name(), item);
+    }
+
+    json.insert("devices", devices);
+    return json;
+}
+
+void PortThread::statisticsTimeout(void)
+{
+    emit statisticsUpdated(m_portId, statistics(QDateTime::currentMSecsSinceEpoch(), true));
+}
+
+void PortThread::publishCapacity(void)
+{
+    QJsonObject json;
+
+    if (m_busy)
+    {
+        m_capacityPending = true;
+        return;
+    }
+
+    json = capacity(m_portId, m_devices->snapshot(), m_tcp);
+
+    if (!json.value("feasible").toBool())
+        logWarning << this << "poll program does not fit into bus capacity, predicted utilization is" << json.value("utilization").toDouble() << "%";
+
+    emit capacityUpdated(m_portId, json);
+}
+
+void PortThread::scanFastModbus(bool resolve, qint32 baudRate)
+{
+    QList <Device> list = m_devices->snapshot();
+    QJsonArray devices;
+    QList <quint8> used, found;
+    QByteArray request = Modbus::fastRequest(FAST_MODBUS_BROADCAST, Modbus::ScanStart, QByteArray());
+
+    if (m_sniffer)
+    {
+        emit scanUpdated(m_portId, {{"error", "port is in sniffer mode"}});
+        return;
+    }
+
+    if (m_tcp)
+    {
+        emit scanUpdated(m_portId, {{"error", "Fast Modbus scan is not supported over TCP"}});
+        return;
+    }
+
+    if (m_busy)
+    {
+        m_scanPending = true;
+        m_scanResolve = resolve;
+        m_scanBaudRate = baudRate;
+        return;
+    }
+
+    if (m_device == m_serial ? !m_serial->isOpen() : !m_connected)
+    {
+        emit scanUpdated(m_portId, {{"error", "port is not connected"}});
+        return;
+    }
+
+    if (baudRate <= 0)
+        baudRate = 9600;
+
+    m_busy = true;
+    m_replyTimeout = static_cast <quint32> (ceil(Modbus::silentInterval(baudRate)));
+    updateBaudRate(baudRate);
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        const Device &device = list.at(i);
+
+        if (device->portId() != m_portId)
+            continue;
+
+        used.append(device->slaveId());
+    }
+
+    while (devices.count() < 256 && sendFrame(request, m_eventTimeout) && Modbus::checkCrc(m_replyData) && m_replyData.length() >= 10 && m_replyData.at(2) == Modbus::ScanReply)
+    {
+        quint32 serial = qFromBigEndian <quint32> (*(reinterpret_cast <const quint32*> (m_replyData.constData() + 3)));
+        quint8 slaveId = static_cast <quint8> (m_replyData.at(7));
+        QJsonObject json = {{"serial", static_cast <qint64> (serial)}, {"slaveId", slaveId}};
+
+        if (found.contains(slaveId))
+            json.insert("conflict", true);
+
+        found.append(slaveId);
+        devices.append(json);
+        request = Modbus::fastRequest(FAST_MODBUS_BROADCAST, Modbus::ScanContinue, QByteArray());
+    }
+
+    for (int i = 0; i < devices.count(); i++)
+    {
+        QJsonObject json = devices.at(i).toObject();
+        quint32 serial = static_cast <quint32> (json.value("serial").toDouble());
+        QByteArray reply = serialRequest(serial, QByteArray::fromHex("0300c80006"));
+
+        if (reply.length() >= 14 && reply.at(0) == Modbus::ReadHoldingRegisters)
+        {
+            QString model;
+
+            for (int j = 0; j < 6; j++)
+                if (reply.at(3 + j * 2))
+                    model.append(reply.at(3 + j * 2));
+
+            json.insert("model", model.trimmed());
+        }
+
+        if (resolve && json.value("conflict").toBool())
+        {
+            quint8 slaveId = 1;
+
+            while (slaveId < 248 && (used.contains(slaveId) || found.contains(slaveId)))
+                slaveId++;
+
+            if (slaveId < 248 && !serialRequest(serial, QByteArray::fromHex("060080").append(static_cast <char> (0x00)).append(static_cast <char> (slaveId))).isEmpty())
+            {
+                logInfo << this << "device with serial number" << serial << "moved to slave id" << slaveId;
+                json.insert("slaveId", slaveId);
+                json.remove("conflict");
+                found.append(slaveId);
+            }
+        }
+
+        devices.replace(i, json);
+    }
+
+    m_busy = false;
+
+    logInfo << this << "Fast Modbus scan finished," << devices.count() << "devices found";
+    emit scanUpdated(m_portId, {{"devices", devices}});
+}
+
+void PortThread::scanPort(const QJsonObject &json)
+{
+    if (m_sniffer)
+        return;
+
+    m_scanRequest = json;
+
+    if (m_busy)
+        return;
+
+    startScan();
+}
+
+void PortThread::startScan(void)
+{
+    QJsonArray baudRates = m_scanRequest.value("baudRates").toArray();
+    QString function = m_scanRequest.value("function").toString();
+
+    m_scanBaudRates.clear();
+
+    for (auto it = baudRates.begin(); it != baudRates.end(); it++)
+        if (it->toInt() > 0)
+            m_scanBaudRates.append(it->toInt());
+
+    if (m_scanBaudRates.isEmpty())
+        m_scanBaudRates.append(m_baudRate ? m_baudRate : 9600);
+
+    m_scanFunction = function == "reportSlaveId" ? Modbus::ReportSlaveId : function == "readInputRegisters" ? Modbus::ReadInputRegisters : function == "readCoilStatus" ? Modbus::ReadCoilStatus : Modbus::ReadHoldingRegisters;
+    m_scanAddress = static_cast <quint16> (m_scanRequest.value("address").toInt());
+    m_scanFirst = static_cast <quint8> (qBound(1, m_scanRequest.value("first").toInt(1), 247));
+    m_scanLast = static_cast <quint8> (qBound(static_cast <int> (m_scanFirst), m_scanRequest.value("last").toInt(247), 247));
+    m_scanSlave = m_scanFirst;
+    m_scanIndex = 0;
+    m_scanCount = 0;
+    m_scanRtt = 0;
+    m_scanActive = true;
+    m_scanRequest = QJsonObject();
+
+    m_scanModbus.setTcp(m_tcp);
+    logInfo << this << "scanning slave ids" << m_scanFirst << "to" << m_scanLast << "at" << m_scanBaudRates.count() << "baud rates";
+}
+
+void PortThread::scanProbe(void)
+{
+    QList <Device> list = m_devices->snapshot();
+    qint32 baudRate = m_scanBaudRates.at(m_scanIndex);
+    QByteArray request = m_scanModbus.makeRequest(m_scanSlave, m_scanFunction, m_scanAddress, 1);
+    qint64 timeout = qMax(static_cast <qint64> (ceil(Modbus::frameTime(Modbus::frameLength(request, m_tcp) + 32, baudRate) + Modbus::silentInterval(baudRate) * 2)), m_scanRtt * 2) + SCAN_TIMEOUT_MARGIN;
+    int offset = m_tcp ? 6 : 0;
+    QElapsedTimer elapsed;
+
+    updateBaudRate(baudRate);
+
+    m_replyTimeout = m_device == m_serial ? static_cast <quint32> (ceil(Modbus::silentInterval(baudRate))) : REPLY_TIMEOUT;
+    elapsed.start();
+
+    if (sendFrame(request, timeout) && m_replyData.length() > offset + 2 && static_cast <quint8> (m_replyData.at(offset)) == m_scanSlave && (m_tcp || Modbus::checkCrc(m_replyData)))
+    {
+        QJsonObject json = {{"slaveId", m_scanSlave}, {"baudRate", baudRate}, {"time", elapsed.elapsed()}};
+
+        for (int i = 0; i < list.count(); i++)
+        {
+            const Device &device = list.at(i);
+
+            if (device->portId() != m_portId || device->slaveId() != m_scanSlave)
+                continue;
+
+            json.insert("device", device->name());
+            break;
+        }
+
+        if (m_replyData.at(offset + 1) & 0x80)
+            json.insert("exception", static_cast <quint8> (m_replyData.at(offset + 2)));
+        else if (m_scanFunction == Modbus::ReportSlaveId)
+            json.insert("id", QString(m_replyData.mid(offset + 3, static_cast <quint8> (m_replyData.at(offset + 2))).toHex(':')));
+
+        m_scanRtt = qMax(m_scanRtt, elapsed.elapsed());
+        m_scanCount++;
+
+        emit scanUpdated(m_portId, json);
+    }
+
+    if (m_scanSlave < m_scanLast)
+    {
+        m_scanSlave++;
+        return;
+    }
+
+    m_scanSlave = m_scanFirst;
+
+    if (++m_scanIndex < m_scanBaudRates.count())
+        return;
+
+    m_scanActive = false;
+
+    logInfo << this << "scan finished," << m_scanCount << "devices found";
+    emit scanUpdated(m_portId, {{"finished", true}, {"found", m_scanCount}});
+}
+
+bool PortThread::enqueueAction(const Device &device, quint8 endpointId, const QString &name, const QVariant &data, qint64 time)
+{
+    if (m_sniffer || !m_actions.push({device, endpointId, name, data, time}))
+        return false;
+
+    if (m_wakeup.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, &PortThread::wakeup, Qt::QueuedConnection);
+
+    return true;
+}
+
+void PortThread::dequeueActions(void)
+{
+    PortAction action;
+
+    while (m_actions.pop(action))
+    {
+        if (!action.device->actionTime())
+            action.device->setActionTime(action.time);
+
+        action.device->enqueueAction(action.endpointId, action.name, action.data);
+    }
+}
+
+bool PortThread::sendAction(const Device &device, qint64 time)
+{
+    bool sent = false;
+
+    if (device->broadcast())
+    {
+        if (device->actionTime())
+        {
+            device->statistics().command(time - device->actionTime());
+            device->setActionTime(0);
+        }
+
+        sendBroadcast(device, device->actionQueue().dequeue());
+        device->actionFinished();
+        return true;
+    }
+
+    if (device->availability() != Availability::Offline)
+    {
+        if (device->retryTime() > time)
+            return false;
+
+        if (device->actionQueue().head().isEmpty())
+        {
+            device->actionQueue().dequeue();
+            device->actionFinished();
+            return false;
+        }
+
+        if (device->actionTime())
+        {
+            device->statistics().command(time - device->actionTime());
+            device->setActionTime(0);
+        }
+
+        device->modbus()->updateSequence(device->actionQueue().head());
+        sendRequest(device, device->actionQueue().head());
+        sent = true;
+
+        if (device->errorCount() && device->availability() != Availability::Offline && device->increaseAttempts() < (device->retryCount() ? device->retryCount() : m_retryCount))
+            return sent;
+    }
+
+    device->actionQueue().dequeue();
+    device->resetAttempts();
+    device->actionFinished();
+
+    if (!device->errorCount() && device->parseAction(m_replyData))
+        return sent;
+
+    device->resetPollTime();
+
+    if (device->fullPoll())
+        device->resetPoll();
+
+    return sent;
+}
+
+bool PortThread::serviceActions(void)
+{
+    QList <Device> list = m_devices->snapshot();
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+    bool sent = false;
+
+    dequeueActions();
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        Device device = list.at(i);
+
+        if (device->portId() != m_portId || !device->active() || device->actionQueue().isEmpty())
+            continue;
+
+        device->modbus()->setTcp(m_tcp);
+
+        if (sendAction(device, time))
+            sent = true;
+    }
+
+    return sent;
+}
+
+bool PortThread::pendingActions(const QList <Device> &list, qint64 time)
+{
+    if (!m_actions.empty())
+        return true;
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        const Device &device = list.at(i);
+
+        if (device->portId() != m_portId || !device->active() || device->actionQueue().isEmpty())
+            continue;
+
+        if (device->broadcast() || device->availability() == Availability::Offline || device->retryTime() <= time)
+            return true;
+    }
+
+    return false;
+}
+
+void PortThread::wakeup(void)
+{
+    m_wakeup.storeRelease(0);
+    poll();
+}
+
 void PortThread::poll(void)
 {
+    QList <Device> list = m_devices->snapshot();
     QByteArray request;
+    Device probe;
+    bool idle = true;
 
-    if (m_busy || (m_device == m_serial ? !m_serial->isOpen() : !m_connected))
+    if (m_sniffer || m_busy || (m_device == m_serial ? !m_serial->isOpen() : !m_connected))
         return;
 
     m_busy = true;
+    updateLoad();
 
-    for (int i = 0; i < m_devices->count(); i++)
+    if (serviceActions())
+        idle = false;
+
+    for (int i = 0; i < list.count(); i++)
     {
-        Device device = m_devices->at(i);
+        Device device = list.at(i);
+        qint64 time = QDateTime::currentMSecsSinceEpoch();
 
         if (device->portId() != m_portId || !device->active())
             continue;
 
+        if (pendingActions(list, time) && serviceActions())
+        {
+            idle = false;
+            time = QDateTime::currentMSecsSinceEpoch();
+        }
+
         device->modbus()->setTcp(m_tcp);
+        device->setGestures(m_gestures);
 
-        if (!device->actionQueue().isEmpty())
+        if (device->broadcast())
         {
-            request = device->actionQueue().dequeue();
+            if (device->actionQueue().isEmpty())
+                continue;
 
-            while (device->availability() != Availability::Offline)
-            {
-                sendRequest(device, request);
+            sendAction(device, time);
+            idle = false;
+            continue;
+        }
 
-                if (device->errorCount())
-                    continue;
+        if (!device->actionQueue().isEmpty())
+        {
+            if (sendAction(device, time))
+                idle = false;
 
-                break;
-            }
+            continue;
+        }
 
-            device->actionFinished();
-            device->resetPollTime();
+        if (device->availability() == Availability::Offline)
+        {
+            if (device->retryTime() <= time && (probe.isNull() || device->retryTime() < probe->retryTime()))
+                probe = device;
 
-            if (device->fullPoll())
-                device->resetPoll();
+            continue;
+        }
 
+        if (device->retryTime() > time)
             continue;
+
+        if (m_fastModbus && !m_tcp && !device->eventsChecked())
+        {
+            request = device->subscriptionRequest();
+            device->setEventsChecked(true);
+
+            if (!request.isEmpty())
+            {
+                sendRequest(device, request);
+                idle = false;
+
+                device->setEvents(!device->errorCount() && m_replyData.length() > 3 && m_replyData.at(1) == Modbus::FastModbus && m_replyData.at(2) == Modbus::EventControl);
+                logDebug(m_debug) << this << device << "events subscription" << (device->events() ? "enabled" : "not supported");
+                continue;
+            }
         }
 
-        if (device->pollTime() + device->pollInterval() > QDateTime::currentMSecsSinceEpoch())
+        if (device->pollTime() + pollInterval(device) > time)
             continue;
 
+        if (!device->polling())
+            device->statistics().startSweep(time, device->pollTime() ? time - device->pollTime() - pollInterval(device) : 0);
+
         device->startPoll();
         request = device->pollRequest();
 
         if (request.isEmpty())
+        {
+            if (device->statistics().finishSweep(QDateTime::currentMSecsSinceEpoch(), device->pollInterval()) && !device->lowPriority())
+                m_overruns++;
+
             continue;
+        }
 
         sendRequest(device, request);
+        idle = false;
 
         if (device->errorCount())
             continue;
@@ -332,5 +1288,44 @@ void PortThread::poll(void)
         device->parseReply(m_replyData);
     }
 
+    if (pendingActions(list, QDateTime::currentMSecsSinceEpoch()) && serviceActions())
+        idle = false;
+
+    if (m_fastModbus && !m_tcp && m_eventTime + m_eventInterval <= QDateTime::currentMSecsSinceEpoch())
+    {
+        pollEvents();
+        m_eventTime = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    if (m_scanActive)
+    {
+        scanProbe();
+        idle = false;
+    }
+
+    if (idle && !probe.isNull() && m_probeTime + m_probeInterval <= QDateTime::currentMSecsSinceEpoch())
+    {
+        sendRequest(probe, probe->probeRequest());
+        m_probeTime = QDateTime::currentMSecsSinceEpoch();
+
+        if (!probe->errorCount())
+            probe->resetPollTime();
+    }
+
     m_busy = false;
+
+    if (m_capacityPending)
+    {
+        m_capacityPending = false;
+        publishCapacity();
+    }
+
+    if (!m_scanRequest.isEmpty())
+        startScan();
+
+    if (!m_scanPending)
+        return;
+
+    m_scanPending = false;
+    scanFastModbus(m_scanResolve, m_scanBaudRate);
 }
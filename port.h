@@ -3,11 +3,21 @@
 
 #define RESET_TIMEOUT           5000
 #define RFC_REQUEST_TIMEOUT     1000
-
+#define OFFLINE_ERROR_COUNT     3
+#define LOAD_WINDOW             1000
+#define SHEDDING_LIMIT          16
+#define EVENT_BATCH_COUNT       16
+#define EVENT_MAX_LENGTH        0xF8
+#define SCAN_TIMEOUT_MARGIN     10
+#define REPLY_TIMEOUT           20
+#define ACTION_QUEUE_SIZE       256
+
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QSerialPort>
 #include <QThread>
 #include "device.h"
+#include "ring.h"
 
 enum class RFCMode
 {
@@ -16,6 +26,15 @@ enum class RFCMode
     Simlar
 };
 
+struct PortAction
+{
+    Device device;
+    quint8 endpointId;
+    QString name;
+    QVariant data;
+    qint64 time;
+};
+
 class PortThread;
 typedef QSharedPointer <PortThread> Port;
 
@@ -25,14 +44,27 @@ class PortThread : public QThread
 
 public:
 
-    PortThread(quint8 portId, const QString &portName, bool tcp, bool rfc, bool debug, DeviceList *devices);
+    PortThread(quint8 portId, QSettings *config, DeviceList *devices);
     ~PortThread(void);
 
     inline quint8 portId(void) { return m_portId; }
+    inline bool sniffer(void) { return m_sniffer; }
+
+    static QJsonObject capacity(quint8 portId, const QList <Device> &devices, bool tcp);
+
+    bool enqueueAction(const Device &device, quint8 endpointId, const QString &name, const QVariant &data, qint64 time);
+
+public slots:
+
+    void publishStatistics(void);
+    void publishCapacity(void);
+    void scanFastModbus(bool resolve, qint32 baudRate);
+    void scanPort(const QJsonObject &json);
 
 private:
 
-    QTimer *m_receiveTimer, *m_resetTimer, *m_pollTimer;
+    QTimer *m_receiveTimer, *m_resetTimer, *m_pollTimer, *m_statisticsTimer;
+    GestureEngine *m_gestures;
 
     QSerialPort *m_serial;
     QTcpSocket *m_socket;
@@ -40,7 +72,7 @@ private:
 
     quint8 m_portId;
     QString m_portName;
-    bool m_tcp, m_rfc, m_debug, m_serialError, m_busy;
+    bool m_tcp, m_rfc, m_debug, m_rtuTiming, m_lowLatency, m_sniffer, m_serialError, m_busy;
 
     QHostAddress m_adddress;
     quint16 m_port;
@@ -51,12 +83,80 @@ private:
 
     QByteArray m_replyData;
     quint32 m_replyTimeout;
+    int m_replyLength;
+    QElapsedTimer m_frameTimer;
+
+    QByteArray m_captureRequest;
+    qint64 m_captureTime;
+
+    quint8 m_retryCount;
+    quint32 m_retryDelay, m_retryJitter, m_offlineDelay, m_offlineLimit;
+
+    quint32 m_turnaroundDelay;
+
+    bool m_adaptiveTimeout;
+    quint32 m_timeoutFloor, m_timeoutCeiling;
+
+    quint32 m_probeInterval;
+    qint64 m_probeTime;
+
+    Statistics m_statistics;
+    quint32 m_statisticsInterval;
+
+    bool m_loadShedding;
+    double m_sheddingThreshold, m_load, m_stretch;
+    qint64 m_loadTime, m_loadBusy;
+    quint32 m_overruns;
+
+    bool m_capacityPending;
+
+    bool m_fastModbus;
+    quint32 m_eventInterval, m_eventTimeout;
+    qint64 m_eventTime;
+    QByteArray m_eventConfirm;
+
+    bool m_scanPending, m_scanResolve;
+    qint32 m_scanBaudRate;
+
+    Modbus m_scanModbus;
+    QJsonObject m_scanRequest;
+    QList <qint32> m_scanBaudRates;
+    Modbus::FunctionCode m_scanFunction;
+    quint16 m_scanAddress, m_scanCount;
+    quint8 m_scanFirst, m_scanLast, m_scanSlave;
+    int m_scanIndex;
+    qint64 m_scanRtt;
+    bool m_scanActive;
+
+    Ring <PortAction, ACTION_QUEUE_SIZE> m_actions;
+    QAtomicInt m_wakeup;
 
     DeviceList *m_devices;
 
     void init(void);
     void rfcRequest(qint32 baudRate = 0);
+    void setLowLatency(void);
+    void updateBaudRate(qint32 baudRate);
+    bool sendFrame(const QByteArray &request, qint64 timeout);
     void sendRequest(const Device &device, const QByteArray &request);
+    void sendBroadcast(const Device &device, const QByteArray &request);
+    int expectedLength(void);
+    void captureFrame(const QByteArray &frame);
+    void pollEvents(void);
+    QByteArray serialRequest(quint32 serial, const QByteArray &request);
+    void startScan(void);
+    void scanProbe(void);
+    qint64 retryDelay(const Device &device);
+    qint64 requestTimeout(const Device &device);
+    void updateStatistics(const Device &device, const QByteArray &request, qint64 elapsed, bool timeout);
+    void updateLoad(void);
+    void dequeueActions(void);
+    bool sendAction(const Device &device, qint64 time);
+    bool serviceActions(void);
+    bool pendingActions(const QList <Device> &list, qint64 time);
+
+    qint64 pollInterval(const Device &device);
+    QJsonObject statistics(qint64 time, bool resetWindow);
 
 private slots:
 
@@ -71,12 +171,17 @@ private slots:
     void readyRead(void);
 
     void reset(void);
+    void wakeup(void);
     void poll(void);
+    void statisticsTimeout(void);
 
 signals:
 
     void replyReceived(void);
-    void updateAvailability(DeviceObject *device);
+    void updateAvailability(const Device &device);
+    void statisticsUpdated(quint8 portId, const QJsonObject &json);
+    void capacityUpdated(quint8 portId, const QJsonObject &json);
+    void scanUpdated(quint8 portId, const QJsonObject &json);
 
 };
 
@@ -0,0 +1,50 @@
+#ifndef RING_H
+#define RING_H
+
+#include <QAtomicInteger>
+
+template <typename T, quint32 size>
+class Ring
+{
+    static_assert(size && !(size & (size - 1)), "ring size must be a power of two");
+
+public:
+
+    Ring(void) :
+        m_head(0), m_tail(0) {}
+
+    inline bool empty(void) { return m_head.loadRelaxed() == m_tail.loadAcquire(); }
+
+    bool push(const T &item)
+    {
+        quint32 tail = m_tail.loadRelaxed();
+
+        if (tail - m_head.loadAcquire() == size)
+            return false;
+
+        m_items[tail & (size - 1)] = item;
+        m_tail.storeRelease(tail + 1);
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        quint32 head = m_head.loadRelaxed();
+
+        if (head == m_tail.loadAcquire())
+            return false;
+
+        item = m_items[head & (size - 1)];
+        m_items[head & (size - 1)] = T();
+        m_head.storeRelease(head + 1);
+        return true;
+    }
+
+private:
+
+    T m_items[size];
+    QAtomicInteger <quint32> m_head, m_tail;
+
+};
+
+#endif
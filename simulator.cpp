@@ -0,0 +1,397 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <QtEndian>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTimer>
+#include "logger.h"
+#include "modbus.h"
+#include "simulator.h"
+
+SimulatorThread::SimulatorThread(QSettings *config) : QThread(nullptr), m_server(nullptr), m_socket(nullptr), m_notifier(nullptr), m_master(-1)
+{
+    m_portName = config->value("simulator/port", "pty").toString();
+    m_link = config->value("simulator/link").toString();
+    m_registers = config->value("simulator/registers").toString();
+    m_tcp = config->value("simulator/tcp", m_portName.startsWith("tcp://")).toBool();
+    m_debug = config->value("simulator/debug", false).toBool();
+
+    m_latency = config->value("simulator/latency", 10).toInt();
+    m_jitter = config->value("simulator/jitter", 0).toInt();
+    m_errorRate = config->value("simulator/errorRate", 0).toInt();
+    m_exceptionRate = config->value("simulator/exceptionRate", 0).toInt();
+
+    if (!m_portName.startsWith("tcp://"))
+    {
+        m_master = posix_openpt(O_RDWR | O_NOCTTY);
+
+        if (m_master < 0 || grantpt(m_master) || unlockpt(m_master))
+        {
+            logWarning << "Simulator pseudo terminal open failed";
+
+            if (m_master >= 0)
+                close(m_master);
+
+            m_master = -1;
+        }
+        else if (!m_link.isEmpty())
+        {
+            QFile::remove(m_link);
+            QFile::link(ptsname(m_master), m_link);
+        }
+    }
+
+    connect(this, &SimulatorThread::started, this, &SimulatorThread::threadStarted);
+    connect(this, &SimulatorThread::finished, this, &SimulatorThread::threadFinished);
+
+    moveToThread(this);
+    start();
+}
+
+SimulatorThread::~SimulatorThread(void)
+{
+    quit();
+    wait();
+}
+
+void SimulatorThread::loadRegisters(void)
+{
+    QFile file(m_registers);
+    QJsonObject json;
+    QList <QString> types = {"coils", "discrete", "holding", "input"};
+
+    if (m_registers.isEmpty() || !file.open(QFile::ReadOnly))
+        return;
+
+    json = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    for (auto it = json.begin(); it != json.end(); it++)
+    {
+        QJsonObject item = it.value().toObject();
+        SimulatorSlave slave;
+        QList <QMap <quint16, quint16>*> maps = {&slave.coils, &slave.discrete, &slave.holding, &slave.input};
+
+        for (int i = 0; i < types.count(); i++)
+        {
+            QJsonObject registers = item.value(types.at(i)).toObject();
+
+            for (auto jt = registers.begin(); jt != registers.end(); jt++)
+                maps.at(i)->insert(static_cast <quint16> (jt.key().toInt(nullptr, 0)), static_cast <quint16> (jt.value().toInt()));
+        }
+
+        m_slaves.insert(static_cast <quint8> (it.key().toInt()), slave);
+    }
+
+    logInfo << "Simulator registers for" << m_slaves.count() << "slaves loaded";
+}
+
+int SimulatorThread::requestLength(void)
+{
+    if (m_tcp)
+        return m_buffer.length() < 6 ? 0 : qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (m_buffer.constData() + 4))) + 6;
+
+    if (m_buffer.length() < 2)
+        return 0;
+
+    switch (static_cast <quint8> (m_buffer.at(1)))
+    {
+        case Modbus::ReadCoilStatus:
+        case Modbus::ReadInputStatus:
+        case Modbus::ReadHoldingRegisters:
+        case Modbus::ReadInputRegisters:
+        case Modbus::WriteSingleCoil:
+        case Modbus::WriteSingleRegister:
+            return 8;
+
+        case Modbus::WriteMultipleCoils:
+        case Modbus::WriteMultipleRegisters:
+            return m_buffer.length() < 7 ? 0 : 9 + static_cast <quint8> (m_buffer.at(6));
+
+        case Modbus::ReadWriteMultipleRegisters:
+            return m_buffer.length() < 11 ? 0 : 13 + static_cast <quint8> (m_buffer.at(10));
+
+        case Modbus::ReportSlaveId:
+            return 4;
+
+        default:
+            return -1;
+    }
+}
+
+QByteArray SimulatorThread::readRegisters(const QMap <quint16, quint16> &map, quint16 address, quint16 count)
+{
+    QByteArray data;
+
+    data.append(static_cast <char> (count * 2));
+
+    for (quint16 i = 0; i < count; i++)
+    {
+        quint16 value = qToBigEndian(map.value(address + i));
+        data.append(reinterpret_cast <char*> (&value), sizeof(value));
+    }
+
+    return data;
+}
+
+QByteArray SimulatorThread::readBits(const QMap <quint16, quint16> &map, quint16 address, quint16 count)
+{
+    QByteArray data;
+
+    data.append(static_cast <char> ((count + 7) / 8));
+
+    for (quint16 i = 0; i < count; i += 8)
+    {
+        quint8 value = 0;
+
+        for (quint16 j = i; j < i + 8 && j < count; j++)
+            if (map.value(address + j))
+                value |= 1 << (j - i);
+
+        data.append(static_cast <char> (value));
+    }
+
+    return data;
+}
+
+QByteArray SimulatorThread::handleRequest(const QByteArray &request)
+{
+    quint8 slaveId = static_cast <quint8> (request.at(0)), functionCode = static_cast <quint8> (request.at(1));
+    quint16 address = 0, count = 0;
+    QByteArray reply = request.left(2);
+    QList <quint8> list;
+
+    if (request.length() >= 6)
+    {
+        address = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + 2)));
+        count = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + 4)));
+    }
+
+    if (slaveId && !m_slaves.contains(slaveId))
+        m_slaves.insert(slaveId, m_slaves.value(0));
+
+    list = slaveId ? QList <quint8> {slaveId} : m_slaves.keys();
+    list.removeAll(0);
+
+    if (slaveId && m_exceptionRate && QRandomGenerator::global()->bounded(100) < static_cast <int> (m_exceptionRate))
+        return reply.replace(1, 1, QByteArray(1, static_cast <char> (functionCode | 0x80))).append(static_cast <char> (Modbus::SlaveDeviceBusy));
+
+    for (int i = 0; i < list.count(); i++)
+    {
+        SimulatorSlave &slave = m_slaves[list.at(i)];
+
+        switch (functionCode)
+        {
+            case Modbus::WriteSingleCoil:
+                slave.coils.insert(address, count == 0xFF00 ? 1 : 0);
+                break;
+
+            case Modbus::WriteSingleRegister:
+                slave.holding.insert(address, count);
+                break;
+
+            case Modbus::WriteMultipleCoils:
+
+                for (quint16 j = 0; j < count && 7 + j / 8 < request.length(); j++)
+                    slave.coils.insert(address + j, request.at(7 + j / 8) & 1 << j % 8 ? 1 : 0);
+
+                break;
+
+            case Modbus::WriteMultipleRegisters:
+
+                for (quint16 j = 0; j < count && 8 + j * 2 < request.length(); j++)
+                    slave.holding.insert(address + j, qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + 7 + j * 2))));
+
+                break;
+
+            case Modbus::ReadWriteMultipleRegisters:
+            {
+                if (request.length() < 11)
+                    break;
+
+                quint16 writeAddress = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + 6))), writeCount = qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + 8)));
+
+                for (quint16 j = 0; j < writeCount && 12 + j * 2 < request.length(); j++)
+                    slave.holding.insert(writeAddress + j, qFromBigEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + 11 + j * 2))));
+
+                break;
+            }
+        }
+    }
+
+    if (!slaveId)
+        return QByteArray();
+
+    switch (functionCode)
+    {
+        case Modbus::ReadCoilStatus:
+        case Modbus::ReadInputStatus:
+
+            if (!count || count > 2000)
+                break;
+
+            return reply.append(readBits(functionCode == Modbus::ReadCoilStatus ? m_slaves[slaveId].coils : m_slaves[slaveId].discrete, address, count));
+
+        case Modbus::ReadHoldingRegisters:
+        case Modbus::ReadInputRegisters:
+        case Modbus::ReadWriteMultipleRegisters:
+
+            if (!count || count > 125)
+                break;
+
+            return reply.append(readRegisters(functionCode == Modbus::ReadInputRegisters ? m_slaves[slaveId].input : m_slaves[slaveId].holding, address, count));
+
+        case Modbus::WriteSingleCoil:
+        case Modbus::WriteSingleRegister:
+        case Modbus::WriteMultipleCoils:
+        case Modbus::WriteMultipleRegisters:
+            return request.left(6);
+
+        case Modbus::ReportSlaveId:
+        {
+            QByteArray data = QByteArray(1, static_cast <char> (slaveId)).append(static_cast <char> (0xFF)).append("HOMEd simulator");
+            return reply.append(static_cast <char> (data.length())).append(data);
+        }
+
+        default:
+            return reply.replace(1, 1, QByteArray(1, static_cast <char> (functionCode | 0x80))).append(static_cast <char> (Modbus::IllegalFunction));
+    }
+
+    return reply.replace(1, 1, QByteArray(1, static_cast <char> (functionCode | 0x80))).append(static_cast <char> (Modbus::IllegalDataValue));
+}
+
+void SimulatorThread::sendReply(const QByteArray &reply)
+{
+    logDebug(m_debug) << "Simulator data sent:" << reply.toHex(':');
+
+    if (m_socket)
+    {
+        m_socket->write(reply);
+        return;
+    }
+
+    if (::write(m_master, reply.constData(), reply.length()) == reply.length())
+        return;
+
+    logWarning << "Simulator reply write failed";
+}
+
+void SimulatorThread::threadStarted(void)
+{
+    loadRegisters();
+
+    if (m_portName.startsWith("tcp://"))
+    {
+        QList <QString> list = QString(m_portName).remove("tcp://").split(':');
+
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, &SimulatorThread::newConnection);
+
+        if (!m_server->listen(QHostAddress(list.value(0)), static_cast <quint16> (list.value(1).toInt())))
+        {
+            logWarning << "Simulator listener" << m_portName << "error:" << m_server->errorString();
+            return;
+        }
+
+        logInfo << "Simulator listening on" << m_portName;
+        return;
+    }
+
+    if (m_master < 0)
+        return;
+
+    m_notifier = new QSocketNotifier(m_master, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &SimulatorThread::readyRead);
+
+    logInfo << "Simulator serial port" << (m_link.isEmpty() ? QString(ptsname(m_master)) : m_link) << "opened successfully";
+}
+
+void SimulatorThread::threadFinished(void)
+{
+    if (m_master < 0)
+        return;
+
+    if (!m_link.isEmpty())
+        QFile::remove(m_link);
+
+    close(m_master);
+}
+
+void SimulatorThread::newConnection(void)
+{
+    if (m_socket)
+        m_socket->deleteLater();
+
+    m_socket = m_server->nextPendingConnection();
+    m_buffer.clear();
+
+    connect(m_socket, &QTcpSocket::readyRead, this, &SimulatorThread::readyRead);
+}
+
+void SimulatorThread::readyRead(void)
+{
+    int length;
+
+    if (m_socket)
+        m_buffer.append(m_socket->readAll());
+    else
+    {
+        char data[256];
+        ssize_t count = ::read(m_master, data, sizeof(data));
+
+        if (count <= 0)
+            return;
+
+        m_buffer.append(data, static_cast <int> (count));
+    }
+
+    while ((length = requestLength()) && m_buffer.length() >= length)
+    {
+        QByteArray request, reply;
+
+        if (length < 0)
+        {
+            logDebug(m_debug) << "Simulator unsupported request dropped:" << m_buffer.toHex(':');
+            m_buffer.clear();
+            break;
+        }
+
+        request = m_buffer.left(length);
+        m_buffer.remove(0, length);
+
+        logDebug(m_debug) << "Simulator data received:" << request.toHex(':');
+
+        if (!m_tcp && qFromLittleEndian <quint16> (*(reinterpret_cast <const quint16*> (request.constData() + length - 2))) != Modbus::crc16(request.left(length - 2)))
+        {
+            logDebug(m_debug) << "Simulator request CRC mismatch";
+            continue;
+        }
+
+        if (m_tcp && length < 8)
+            continue;
+
+        if (m_errorRate && QRandomGenerator::global()->bounded(100) < static_cast <int> (m_errorRate))
+            continue;
+
+        reply = handleRequest(m_tcp ? request.mid(6) : request.left(length - 2));
+
+        if (reply.isEmpty())
+            continue;
+
+        if (m_tcp)
+        {
+            quint16 value = qToBigEndian <quint16> (reply.length());
+            reply.prepend(reinterpret_cast <char*> (&value), sizeof(value)).prepend(request.left(4));
+        }
+        else
+        {
+            quint16 crc = qToLittleEndian(Modbus::crc16(reply));
+            reply.append(reinterpret_cast <char*> (&crc), sizeof(crc));
+        }
+
+        QTimer::singleShot(m_latency + (m_jitter ? QRandomGenerator::global()->bounded(m_jitter + 1) : 0), this, [this, reply] () { sendReply(reply); });
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <QMap>
+#include <QSettings>
+#include <QSocketNotifier>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+struct SimulatorSlave
+{
+    QMap <quint16, quint16> coils, discrete, holding, input;
+};
+
+class SimulatorThread;
+typedef QSharedPointer <SimulatorThread> Simulator;
+
+class SimulatorThread : public QThread
+{
+    Q_OBJECT
+
+public:
+
+    SimulatorThread(QSettings *config);
+    ~SimulatorThread(void);
+
+private:
+
+    QTcpServer *m_server;
+    QTcpSocket *m_socket;
+    QSocketNotifier *m_notifier;
+
+    QString m_portName, m_link, m_registers;
+    bool m_tcp, m_debug;
+    int m_master;
+
+    quint32 m_latency, m_jitter, m_errorRate, m_exceptionRate;
+
+    QByteArray m_buffer;
+    QMap <quint8, SimulatorSlave> m_slaves;
+
+    void loadRegisters(void);
+    int requestLength(void);
+
+    QByteArray readRegisters(const QMap <quint16, quint16> &map, quint16 address, quint16 count);
+    QByteArray readBits(const QMap <quint16, quint16> &map, quint16 address, quint16 count);
+    QByteArray handleRequest(const QByteArray &request);
+
+    void sendReply(const QByteArray &reply);
+
+private slots:
+
+    void threadStarted(void);
+    void threadFinished(void);
+
+    void newConnection(void);
+    void readyRead(void);
+
+};
+
+#endif
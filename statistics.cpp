@@ -0,0 +1,118 @@
+#include <math.h>
+#include <algorithm>
+#include <QDateTime>
+#include "statistics.h"
+
+void Latency::append(qint64 value)
+{
+    m_samples[m_index] = static_cast <quint32> (qMax <qint64> (value, 0));
+    m_index = (m_index + 1) % STATISTICS_SAMPLES;
+
+    if (m_count < STATISTICS_SAMPLES)
+        m_count++;
+}
+
+QJsonObject Latency::json(void)
+{
+    quint32 samples[STATISTICS_SAMPLES];
+
+    if (!m_count)
+        return QJsonObject();
+
+    memcpy(samples, m_samples, m_count * sizeof(quint32));
+    std::sort(samples, samples + m_count);
+
+    return {{"p50", static_cast <qint64> (samples[(m_count - 1) * 50 / 100])}, {"p90", static_cast <qint64> (samples[(m_count - 1) * 90 / 100])}, {"p99", static_cast <qint64> (samples[(m_count - 1) * 99 / 100])}, {"max", static_cast <qint64> (samples[m_count - 1])}};
+}
+
+void Statistics::transaction(qint64 sent, qint64 received, qint64 elapsed)
+{
+    if (!m_windowTime)
+        m_windowTime = QDateTime::currentMSecsSinceEpoch() - elapsed;
+
+    m_transactions++;
+    m_bytesSent += sent;
+    m_bytesReceived += received;
+    m_busyTime += elapsed;
+    m_rtt.append(elapsed);
+}
+
+void Statistics::timeout(qint64 sent, qint64 elapsed)
+{
+    if (!m_windowTime)
+        m_windowTime = QDateTime::currentMSecsSinceEpoch() - elapsed;
+
+    m_transactions++;
+    m_timeouts++;
+    m_bytesSent += sent;
+    m_busyTime += elapsed;
+}
+
+void Statistics::startSweep(qint64 time, qint64 delay)
+{
+    if (m_sweepStart)
+        m_interval = time - m_sweepStart;
+
+    m_sweepStart = time;
+    m_sweepDelay = delay > 0 ? delay : 0;
+}
+
+bool Statistics::finishSweep(qint64 time, qint64 interval)
+{
+    if (!m_sweepStart)
+        return false;
+
+    m_sweepLast = time - m_sweepStart;
+    m_sweepMax = qMax(m_sweepMax, m_sweepLast);
+
+    if (!interval || m_sweepLast + m_sweepDelay <= interval)
+        return false;
+
+    m_overruns++;
+    return true;
+}
+
+QJsonObject Statistics::json(qint64 time)
+{
+    QJsonObject json = {{"transactions", static_cast <qint64> (m_transactions)}, {"timeouts", static_cast <qint64> (m_timeouts)}, {"crcErrors", static_cast <qint64> (m_crcErrors)}, {"bytesSent", static_cast <qint64> (m_bytesSent)}, {"bytesReceived", static_cast <qint64> (m_bytesReceived)}};
+
+    if (!m_exceptions.isEmpty())
+    {
+        QJsonObject exceptions;
+
+        for (auto it = m_exceptions.begin(); it != m_exceptions.end(); it++)
+            exceptions.insert(QString::number(it.key()), static_cast <qint64> (it.value()));
+
+        json.insert("exceptions", exceptions);
+    }
+
+    if (m_rtt.count())
+        json.insert("rtt", m_rtt.json());
+
+    if (m_command.count())
+        json.insert("command", m_command.json());
+
+    if (m_sweepLast)
+        json.insert("sweep", QJsonObject {{"last", m_sweepLast}, {"max", m_sweepMax}, {"delay", m_sweepDelay}});
+
+    if (m_interval)
+        json.insert("effectiveInterval", m_interval);
+
+    if (m_overruns)
+        json.insert("overruns", static_cast <qint64> (m_overruns));
+
+    if (m_windowTime && time > m_windowTime)
+    {
+        json.insert("utilization", round(static_cast <double> (m_busyTime - m_windowBusyTime) * 1000 / (time - m_windowTime)) / 10);
+        json.insert("rate", round(static_cast <double> (m_transactions - m_windowTransactions) * 10000 / (time - m_windowTime)) / 10);
+    }
+
+    return json;
+}
+
+void Statistics::reset(qint64 time)
+{
+    m_windowBusyTime = m_busyTime;
+    m_windowTransactions = m_transactions;
+    m_windowTime = time;
+}
@@ -0,0 +1,66 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#define STATISTICS_SAMPLES      256
+
+#include <QJsonObject>
+#include <QMap>
+
+class Latency
+{
+
+public:
+
+    Latency(void) :
+        m_index(0), m_count(0) {}
+
+    inline quint16 count(void) { return m_count; }
+
+    void append(qint64 value);
+    QJsonObject json(void);
+
+private:
+
+    quint32 m_samples[STATISTICS_SAMPLES];
+    quint16 m_index, m_count;
+
+};
+
+class Statistics
+{
+
+public:
+
+    Statistics(void) :
+        m_transactions(0), m_timeouts(0), m_crcErrors(0), m_bytesSent(0), m_bytesReceived(0), m_busyTime(0), m_windowBusyTime(0), m_windowTime(0), m_windowTransactions(0), m_sweepStart(0), m_sweepLast(0), m_sweepMax(0), m_sweepDelay(0), m_interval(0), m_overruns(0) {}
+
+    void transaction(qint64 sent, qint64 received, qint64 elapsed);
+    void timeout(qint64 sent, qint64 elapsed);
+
+    inline void command(qint64 elapsed) { m_command.append(elapsed); }
+
+    inline void crcError(void) { m_crcErrors++; }
+    inline void exception(quint8 code) { m_exceptions[code]++; }
+
+    void startSweep(qint64 time, qint64 delay);
+    bool finishSweep(qint64 time, qint64 interval);
+
+    QJsonObject json(qint64 time);
+    void reset(qint64 time);
+
+private:
+
+    quint32 m_transactions, m_timeouts, m_crcErrors;
+    quint64 m_bytesSent, m_bytesReceived;
+    qint64 m_busyTime, m_windowBusyTime, m_windowTime;
+    quint32 m_windowTransactions;
+    qint64 m_sweepStart, m_sweepLast, m_sweepMax, m_sweepDelay, m_interval;
+    quint32 m_overruns;
+
+    QMap <quint8, quint32> m_exceptions;
+
+    Latency m_rtt, m_command;
+
+};
+
+#endif
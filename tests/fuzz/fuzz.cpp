@@ -0,0 +1,44 @@
+#include <QVector>
+#include "modbus.h"
+
+static const Modbus::FunctionCode functionCodes[] =
+{
+    Modbus::ReadCoilStatus,
+    Modbus::ReadInputStatus,
+    Modbus::ReadHoldingRegisters,
+    Modbus::ReadInputRegisters,
+    Modbus::WriteSingleCoil,
+    Modbus::WriteSingleRegister,
+    Modbus::WriteMultipleCoils,
+    Modbus::WriteMultipleRegisters,
+    Modbus::ReportSlaveId,
+    Modbus::ReadWriteMultipleRegisters
+};
+
+// first byte selects the transport and function code, second byte the destination buffer size, the rest is the received frame
+
+extern "C" int LLVMFuzzerTestOneInput(const quint8 *data, size_t size)
+{
+    Modbus modbus;
+    QByteArray reply;
+    QVector <quint16> buffer;
+    quint8 slaveAddress;
+    bool tcp;
+
+    if (size < 2)
+        return 0;
+
+    tcp = data[0] & 0x01;
+    reply = QByteArray(reinterpret_cast <const char*> (data + 2), static_cast <int> (size - 2));
+    buffer.resize(data[1] % 128 + 1);
+    slaveAddress = static_cast <quint8> (reply.length() > (tcp ? 6 : 0) ? reply.at(tcp ? 6 : 0) : 0);
+
+    modbus.setTcp(tcp);
+    modbus.parseReply(slaveAddress, functionCodes[(data[0] >> 1) % (sizeof(functionCodes) / sizeof(functionCodes[0]))], reply);
+    modbus.parseReply(slaveAddress, functionCodes[(data[0] >> 1) % (sizeof(functionCodes) / sizeof(functionCodes[0]))], reply, buffer.data(), buffer.count());
+
+    Modbus::checkCrc(reply);
+    Modbus::replyLength(reply, tcp);
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../modbus.h
+
+SOURCES += \
+    ../../modbus.cpp \
+    fuzz.cpp
+
+QT -= gui
+CONFIG += console
+
+QMAKE_CC = clang
+QMAKE_CXX = clang++
+QMAKE_LINK = clang++
+QMAKE_CXXFLAGS += -fsanitize=fuzzer,address,undefined
+QMAKE_LFLAGS += -fsanitize=fuzzer,address,undefined
@@ -0,0 +1,13 @@
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../modbus.h
+
+SOURCES += \
+    ../../modbus.cpp \
+    tst_modbus.cpp
+
+QT -= gui
+QT += testlib
+CONFIG += console testcase
+TARGET = tst_modbus
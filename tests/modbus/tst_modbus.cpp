@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <QtEndian>
+#include <QtTest>
+#include "modbus.h"
+
+class ModbusTest : public QObject
+{
+    Q_OBJECT
+
+private:
+
+    QByteArray rtu(const QByteArray &pdu)
+    {
+        quint16 crc = qToLittleEndian(Modbus::crc16(pdu));
+        return QByteArray(pdu).append(reinterpret_cast <char*> (&crc), sizeof(crc));
+    }
+
+    QByteArray tcp(quint16 sequence, const QByteArray &pdu)
+    {
+        quint16 value = qToBigEndian(sequence), length = qToBigEndian <quint16> (pdu.length());
+        return QByteArray(reinterpret_cast <char*> (&value), sizeof(value)).append(2, 0x00).append(reinterpret_cast <char*> (&length), sizeof(length)).append(pdu);
+    }
+
+private slots:
+
+    void readRegisters(void)
+    {
+        Modbus modbus;
+        quint16 data[2] = {0, 0};
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("01030412345678")), data), Modbus::Ok);
+        QCOMPARE(data[0], static_cast <quint16> (0x1234));
+        QCOMPARE(data[1], static_cast <quint16> (0x5678));
+    }
+
+    void writeEcho(void)
+    {
+        Modbus modbus;
+        QCOMPARE(modbus.parseReply(1, Modbus::WriteSingleRegister, rtu(QByteArray::fromHex("01060010002A"))), Modbus::Ok);
+    }
+
+    void shortFrame(void)
+    {
+        Modbus modbus;
+        quint16 data = 0;
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, QByteArray(), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, QByteArray::fromHex("0103"), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, QByteArray::fromHex("010302"), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("0103")), data), Modbus::WrongLength);
+    }
+
+    void truncatedByteCount(void)
+    {
+        Modbus modbus;
+        quint16 data[8];
+
+        std::fill(data, data + 8, 0xAAAA);
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("01030A1234")), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("0103FF")), data), Modbus::WrongLength);
+
+        for (int i = 0; i < 8; i++)
+            QCOMPARE(data[i], static_cast <quint16> (0xAAAA));
+    }
+
+    void oversizedRegisters(void)
+    {
+        Modbus modbus;
+        quint16 data[4];
+
+        std::fill(data, data + 4, 0xAAAA);
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("0103080001000200030004")), data, 2), Modbus::WrongLength);
+
+        for (int i = 0; i < 4; i++)
+            QCOMPARE(data[i], static_cast <quint16> (0xAAAA));
+    }
+
+    void oversizedCoils(void)
+    {
+        Modbus modbus;
+        quint16 data[8];
+
+        std::fill(data, data + 8, 0xAAAA);
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadCoilStatus, rtu(QByteArray::fromHex("010102FFFF")), data, 6), Modbus::Ok);
+
+        for (int i = 0; i < 6; i++)
+            QCOMPARE(data[i], static_cast <quint16> (1));
+
+        QCOMPARE(data[6], static_cast <quint16> (0xAAAA));
+        QCOMPARE(data[7], static_cast <quint16> (0xAAAA));
+    }
+
+    void oversizedSlaveId(void)
+    {
+        Modbus modbus;
+        quint16 data[4];
+
+        std::fill(data, data + 4, 0xAAAA);
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReportSlaveId, rtu(QByteArray::fromHex("0111084142434445464748")), data, 2), Modbus::Ok);
+        QCOMPARE(QByteArray(reinterpret_cast <char*> (data), 4), QByteArray("ABCD"));
+        QCOMPARE(data[2], static_cast <quint16> (0xAAAA));
+        QCOMPARE(data[3], static_cast <quint16> (0xAAAA));
+    }
+
+    void malformedFrame(void)
+    {
+        Modbus modbus;
+        QByteArray frame = rtu(QByteArray::fromHex("0103020001"));
+        quint16 data = 0;
+
+        QCOMPARE(modbus.parseReply(2, Modbus::ReadHoldingRegisters, frame, data), Modbus::WrongSlaveAddress);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadInputRegisters, frame, data), Modbus::WrongFunctionCode);
+
+        frame[frame.length() - 1] = static_cast <char> (frame.at(frame.length() - 1) ^ 0xFF);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, frame, data), Modbus::BadCRC);
+    }
+
+    void exception(void)
+    {
+        Modbus modbus;
+        quint16 data = 0;
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("018302")), data), Modbus::Exception);
+        QCOMPARE(data, static_cast <quint16> (Modbus::IllegalDataAddress));
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, rtu(QByteArray::fromHex("0183")), data), Modbus::WrongLength);
+    }
+
+    void tcpFrames(void)
+    {
+        Modbus modbus;
+        quint16 data = 0;
+
+        modbus.setTcp(true);
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(0, QByteArray::fromHex("010302002A")), data), Modbus::Ok);
+        QCOMPARE(data, static_cast <quint16> (42));
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(0, QByteArray::fromHex("010302002A")), data), Modbus::BadSequence);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(1, QByteArray::fromHex("018304")), data), Modbus::Exception);
+        QCOMPARE(data, static_cast <quint16> (Modbus::SlaveDeviceFailure));
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(1, QByteArray::fromHex("0183")), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(1, QByteArray::fromHex("01")), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(1, QByteArray::fromHex("0103")), data), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(1, QByteArray::fromHex("0103FF")), data), Modbus::WrongLength);
+    }
+
+    void writeMultipleCoils(void)
+    {
+        Modbus modbus;
+        quint16 data[MAX_WRITE_COILS + 1] = {1, 0, 1, 1, 0, 0, 0, 0, 1, 1};
+        QByteArray request = modbus.makeRequest(1, Modbus::WriteMultipleCoils, 0x0010, 10, data);
+
+        QCOMPARE(request, rtu(QByteArray::fromHex("010F0010000A020D03")));
+        QVERIFY(Modbus::checkCrc(request));
+
+        request = modbus.makeRequest(1, Modbus::WriteMultipleCoils, 0x0000, MAX_WRITE_COILS, data);
+        QCOMPARE(request.length(), 9 + (MAX_WRITE_COILS + 7) / 8);
+        QCOMPARE(static_cast <quint8> (request.at(6)), static_cast <quint8> ((MAX_WRITE_COILS + 7) / 8));
+        QVERIFY(Modbus::checkCrc(request));
+
+        QVERIFY(modbus.makeRequest(1, Modbus::WriteMultipleCoils, 0x0000, MAX_WRITE_COILS + 1, data).isEmpty());
+        QVERIFY(modbus.makeRequest(1, Modbus::WriteMultipleRegisters, 0x0000, MAX_WRITE_REGISTERS + 1, data).isEmpty());
+    }
+
+    void readWriteRegisters(void)
+    {
+        Modbus modbus;
+        quint16 value = 0x1234, data[MAX_READ_WRITE_WRITE + 1] = {};
+        QByteArray request = modbus.makeRequest(1, Modbus::ReadWriteMultipleRegisters, 0x0000, 3, &value, 0x0002, 1);
+
+        QCOMPARE(request, rtu(QByteArray::fromHex("0117000000030002000102" "1234")));
+        QVERIFY(Modbus::checkCrc(request));
+
+        QVERIFY(!modbus.makeRequest(1, Modbus::ReadWriteMultipleRegisters, 0x0000, MAX_READ_WRITE_READ, data, 0x0000, MAX_READ_WRITE_WRITE).isEmpty());
+        QVERIFY(modbus.makeRequest(1, Modbus::ReadWriteMultipleRegisters, 0x0000, MAX_READ_WRITE_READ + 1, data, 0x0000, 1).isEmpty());
+        QVERIFY(modbus.makeRequest(1, Modbus::ReadWriteMultipleRegisters, 0x0000, 1, data, 0x0000, MAX_READ_WRITE_WRITE + 1).isEmpty());
+    }
+
+    void readWriteReply(void)
+    {
+        Modbus modbus;
+        quint16 data[3] = {0, 0, 0}, small[2];
+
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadWriteMultipleRegisters, rtu(QByteArray::fromHex("011706000A000B000C")), data), Modbus::Ok);
+        QCOMPARE(data[0], static_cast <quint16> (10));
+        QCOMPARE(data[1], static_cast <quint16> (11));
+        QCOMPARE(data[2], static_cast <quint16> (12));
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadWriteMultipleRegisters, rtu(QByteArray::fromHex("011706000A000B000C")), small), Modbus::WrongLength);
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadWriteMultipleRegisters, rtu(QByteArray::fromHex("011706000A")), data), Modbus::WrongLength);
+    }
+
+    void updateSequence(void)
+    {
+        Modbus modbus;
+        quint16 value = 0x002A, data = 0;
+        QByteArray request;
+
+        modbus.setTcp(true);
+        request = modbus.makeRequest(1, Modbus::ReadWriteMultipleRegisters, 0x0000, 1, &value, 0x0000, 1);
+
+        QCOMPARE(request.left(2), QByteArray::fromHex("0000"));
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadHoldingRegisters, tcp(0, QByteArray::fromHex("010302002A")), data), Modbus::Ok);
+
+        modbus.updateSequence(request);
+
+        QCOMPARE(request.left(2), QByteArray::fromHex("0001"));
+        QCOMPARE(request.mid(2), modbus.makeRequest(1, Modbus::ReadWriteMultipleRegisters, 0x0000, 1, &value, 0x0000, 1).mid(2));
+        QCOMPARE(modbus.parseReply(1, Modbus::ReadWriteMultipleRegisters, tcp(1, QByteArray::fromHex("011702002A")), data), Modbus::Ok);
+        QCOMPARE(data, static_cast <quint16> (42));
+    }
+
+    void matchReply(void)
+    {
+        QByteArray read = rtu(QByteArray::fromHex("010300100002")), write = rtu(QByteArray::fromHex("0110001000020400010002"));
+
+        QVERIFY(Modbus::matchReply(read, rtu(QByteArray::fromHex("01030412345678"))));
+        QVERIFY(Modbus::matchReply(read, rtu(QByteArray::fromHex("018302"))));
+        QVERIFY(!Modbus::matchReply(read, rtu(QByteArray::fromHex("010302002A"))));
+        QVERIFY(!Modbus::matchReply(read, rtu(QByteArray::fromHex("02030412345678"))));
+        QVERIFY(!Modbus::matchReply(read, rtu(QByteArray::fromHex("010300200002"))));
+
+        QVERIFY(Modbus::matchReply(write, rtu(QByteArray::fromHex("011000100002"))));
+        QVERIFY(!Modbus::matchReply(write, rtu(QByteArray::fromHex("011000110002"))));
+        QVERIFY(!Modbus::matchReply(write, rtu(QByteArray::fromHex("011000100001"))));
+
+        QVERIFY(Modbus::matchReply(rtu(QByteArray::fromHex("01060010002A")), rtu(QByteArray::fromHex("01060010002A"))));
+        QVERIFY(!Modbus::matchReply(rtu(QByteArray::fromHex("01060010002A")), rtu(QByteArray::fromHex("01060011002A"))));
+    }
+
+    void frameHelpers(void)
+    {
+        Modbus modbus;
+
+        QCOMPARE(Modbus::replyLength(QByteArray::fromHex("0103"), false), 0);
+        QCOMPARE(Modbus::replyLength(modbus.makeRequest(1, Modbus::ReadHoldingRegisters, 0, 10), false), 25);
+        QCOMPARE(Modbus::replyLength(modbus.makeRequest(1, Modbus::ReadCoilStatus, 0, 9), false), 7);
+
+        QVERIFY(!Modbus::checkCrc(QByteArray()));
+        QVERIFY(!Modbus::checkCrc(QByteArray::fromHex("010203")));
+        QVERIFY(Modbus::checkCrc(rtu(QByteArray::fromHex("0103020001"))));
+    }
+
+};
+
+QTEST_APPLESS_MAIN(ModbusTest)
+
+#include "tst_modbus.moc"